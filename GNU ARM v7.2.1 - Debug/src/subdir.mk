@@ -8,7 +8,8 @@ S_SRCS += \
 
 C_SRCS += \
 ../src/main.c \
-../src/myRTOS.c 
+../src/myRTOS.c \
+../src/myTrace.c 
 
 O_SRCS += \
 ../src/tasks8.o 
@@ -16,11 +17,13 @@ O_SRCS += \
 OBJS += \
 ./src/context.o \
 ./src/main.o \
-./src/myRTOS.o 
+./src/myRTOS.o \
+./src/myTrace.o 
 
 C_DEPS += \
 ./src/main.d \
-./src/myRTOS.d 
+./src/myRTOS.d \
+./src/myTrace.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -45,4 +48,11 @@ src/myRTOS.o: ../src/myRTOS.c
 	@echo 'Finished building: $<'
 	@echo ' '
 
+src/myTrace.o: ../src/myTrace.c
+	@echo 'Building file: $<'
+	@echo 'Invoking: GNU ARM C Compiler'
+	arm-none-eabi-gcc -g3 -gdwarf-2 -mcpu=cortex-m3 -mthumb -std=c99 '-DEFM32GG990F1024=1' -IC:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7/platform/CMSIS/Include -IC:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7/hardware/kit/common/bsp -IC:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7/platform/emlib/inc -IC:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7/hardware/kit/common/drivers -IC:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7/platform/Device/SiliconLabs/EFM32GG/Include -IC:/SiliconLabs/SimplicityStudio/v4/developer/sdks/gecko_sdk_suite/v2.7/hardware/kit/EFM32GG_STK3700/config -IC:/FreeRTOS/FreeRTOSv202012.00/FreeRTOS/Source/include -IC:/FreeRTOS/FreeRTOSv202012.00/FreeRTOS/Source/portable/GCC/ARM_CM3 -IC:/Users/zachp/SimplicityStudio/v4_workspace/myRTOS/myRTOS.c/src -O0 -Wall -c -fmessage-length=0 -mno-sched-prolog -fno-builtin -ffunction-sections -fdata-sections -MMD -MP -MF"src/myTrace.d" -MT"src/myTrace.o" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
 
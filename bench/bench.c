@@ -0,0 +1,534 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Benchmark Suite
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* bench.c holds Thread-Metric style benchmarks of the myRTOS kernel. Each test runs tasks (and an
+*  interrupt) repeating one kernel operation and counting completions; a reporting task at the
+*  highest priority creates them, then reports the operations of every window of
+*  BENCH_WINDOW_TICKS SystemTicks, their average and the latency histograms. Higher is better,
+*  except for the give -> wake latencies of test 11.
+*  Build with NUM_TASKS 7 (idle loop, reporting task and up to five workers).
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include <stdio.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "bench.h"
+
+#if NUM_TASKS < 7
+#error "The benchmarks need NUM_TASKS 7"
+#endif
+
+#ifndef BENCH_STACK_WORDS
+#define BENCH_STACK_WORDS 256 //Stack of every benchmark task (hosts need far more)
+#endif
+
+#define BENCH_REPORTER 1		//Task identifier of the reporting task
+#define BENCH_FIRST_WORKER 2	//Task identifier of worker 0, workers 0-4 follow
+#define BENCH_WORKERS 5			//Most workers a test creates
+#define BENCH_ISR BENCH_WORKERS //BenchCount entry of the interrupt handler
+#define BENCH_BLOCK_BYTES 128	//Block size of the memory allocation test
+#define BENCH_MESSAGE_WORDS 4	//Message size of the message passing test (16 bytes)
+
+//Task Stacks
+static uint32_t BenchStacks[BENCH_WORKERS+1][BENCH_STACK_WORDS];
+
+static volatile uint32_t BenchCount[BENCH_WORKERS+1]; //Operations completed by each worker and the ISR
+static volatile uint32_t BenchErrors;	//Operations that returned wrong data or failed
+static int BenchTest;					//Test being run
+
+//STRUCT: BaselineMailbox
+//DESCRIPTION: The mailbox xMailbox replaced, one int guarded by a space and a data semaphore
+typedef struct {
+	xSemaphore sem_Space;		//Taken while the mailbox is full
+	xSemaphore sem_Data;		//Taken while the mailbox is empty
+	int the_data;				//Data Held by Mailbox
+} BaselineMailbox;
+
+//STRUCT: BenchWake
+//DESCRIPTION: Give -> wake latencies of one wake mechanism, in portCycleCount cycles
+typedef struct {
+	uint32_t samples;			//Wakes measured
+	uint64_t total;				//Sum of their latencies
+	uint32_t max;				//Longest latency
+} BenchWake;
+
+//Kernel objects the tests exercise
+static xSemaphore BenchSemaphore;
+static xSemaphore BenchSignal;
+static xQueue BenchQueue;
+static uint32_t BenchQueueStorage[2][BENCH_MESSAGE_WORDS];
+static xMailbox BenchBox;
+static BaselineMailbox BenchBaselineBox;
+static xBlockPool BenchPool;
+static uint32_t BenchPoolStorage[2][BENCH_BLOCK_BYTES/4];
+
+static volatile uint32_t BenchWakeStamp; //portCycleCount just before the give of the wake test
+static BenchWake BenchWakeSemaphore;	//Wakes through a semaphore
+static BenchWake BenchWakeNotification; //Wakes through a notification
+
+//------------------------------------------------------------------------------------------------//
+// -- 										WORKERS											   -- //
+//------------------------------------------------------------------------------------------------//
+//Index of the calling worker (0-4)
+static int benchWorker(void)
+{
+	return CurrentTask->task - BENCH_FIRST_WORKER;
+}
+
+//Cooperative scheduling: equal priority workers take turns through vTaskYield
+static void Cooperative_Loop(void)
+{
+	int i = benchWorker();
+	while(1)
+	{
+		BenchCount[i]++;
+		vTaskYield();
+	}
+}
+
+//Preemptive scheduling: each worker resumes the next higher priority one, which preempts it, and
+//suspends itself once that one has suspended
+static void Preemptive_Loop(void)
+{
+	int i = benchWorker();
+	while(1)
+	{
+		if(i > 0)
+		{
+			ulTaskNotifyTake(true, WAIT_FOREVER);
+		}
+		BenchCount[i]++;
+		if(i < BENCH_WORKERS-1)
+		{
+			xTaskNotifyGive(BENCH_FIRST_WORKER+i+1);
+		}
+	}
+}
+
+//Interrupt processing: the ISR gives the signalling semaphore the worker takes
+static void Interrupt_Handler(void)
+{
+	BenchCount[BENCH_ISR]++;
+	xSemaphoreGiveFromISR(&BenchSignal);
+}
+
+static void Interrupt_Loop(void)
+{
+	while(1)
+	{
+		benchCauseInterrupt();
+		if(xSemaphoreTakeTimeout(&BenchSignal, 0) != RTOS_OK)
+		{
+			BenchErrors++; //the interrupt was not taken
+		}
+		BenchCount[0]++;
+	}
+}
+
+//Interrupt preemption: the ISR signals worker 1, which preempts worker 0 once the ISR returns
+static void Preemption_Handler(void)
+{
+	BenchCount[BENCH_ISR]++;
+	xSemaphoreGiveFromISR(&BenchSignal);
+}
+
+static void Preemption_Loop(void)
+{
+	int i = benchWorker();
+	while(1)
+	{
+		if(i == 0)
+		{
+			benchCauseInterrupt();
+		}
+		else
+		{
+			xSemaphoreTake(&BenchSignal);
+		}
+		BenchCount[i]++;
+	}
+}
+
+//Message passing: a 16 byte message sent to and received back from a queue
+static void Message_Loop(void)
+{
+	uint32_t message[BENCH_MESSAGE_WORDS] = {0};
+	uint32_t received[BENCH_MESSAGE_WORDS];
+	while(1)
+	{
+		message[BENCH_MESSAGE_WORDS-1] = BenchCount[0];
+		xQueueSend(&BenchQueue, message);
+		xQueueReceive(&BenchQueue, received);
+		if(received[BENCH_MESSAGE_WORDS-1] != message[BENCH_MESSAGE_WORDS-1])
+		{
+			BenchErrors++;
+		}
+		BenchCount[0]++;
+	}
+}
+
+//Synchronization: a binary semaphore taken and given back
+static void Synchronization_Loop(void)
+{
+	while(1)
+	{
+		xSemaphoreTake(&BenchSemaphore);
+		xSemaphoreGive(&BenchSemaphore);
+		BenchCount[0]++;
+	}
+}
+
+//Memory allocation: a 128 byte block allocated and freed
+static void Memory_Loop(void)
+{
+	while(1)
+	{
+		void* block = pvBlockAlloc(&BenchPool);
+		if(block == 0)
+		{
+			BenchErrors++;
+		}
+		else
+		{
+			vBlockFree(&BenchPool, block);
+		}
+		BenchCount[0]++;
+	}
+}
+
+//Mailbox: a value written to and read back from a mailbox
+static void Mailbox_Loop(void)
+{
+	while(1)
+	{
+		int value = (int)BenchCount[0];
+		int received;
+		writeToBox(&BenchBox, &value);
+		readFromBox(&BenchBox, &received);
+		if(received != value)
+		{
+			BenchErrors++;
+		}
+		BenchCount[0]++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: baselineInitMailbox
+//*DESCRIPTION: Initializes the original mailbox: empty, so the data semaphore starts taken. Its
+//*semaphores predate priority inheritance and do not inherit.
+//*INPUTS: Address of the Mailbox
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void baselineInitMailbox(BaselineMailbox *box)
+{
+	initSemaphoreBinary(&box->sem_Space, 1);
+	initSemaphoreBinary(&box->sem_Data, 1);
+	box->sem_Space.inherit = false;
+	box->sem_Data.inherit = false;
+	box->sem_Data.Semaphore = true; //No data initially in the mailbox
+}
+
+//The original writeToBox: wait for space, store the value, signal data
+static void baselineWriteToBox(BaselineMailbox *box, int* stored_data)
+{
+	xSemaphoreTake(&box->sem_Space); //Check Mailbox Status
+	box->the_data = *stored_data;	 //Write Data to Mailbox
+	xSemaphoreGive(&box->sem_Data);  //State Mailbox is Full
+}
+
+//The original readFromBox: wait for data, load the value, signal space
+static void baselineReadFromBox(BaselineMailbox *box, int* returned_data)
+{
+	xSemaphoreTake(&box->sem_Data); //Check if Mailbox has Data
+	*returned_data = box->the_data; //Read Data from Mailbox
+	xSemaphoreGive(&box->sem_Space);//State Mailbox is now Empty
+}
+
+//Mailbox baseline: the mailbox test through the original mailbox
+static void MailboxBaseline_Loop(void)
+{
+	while(1)
+	{
+		int value = (int)BenchCount[0];
+		int received;
+		baselineWriteToBox(&BenchBaselineBox, &value);
+		baselineReadFromBox(&BenchBaselineBox, &received);
+		if(received != value)
+		{
+			BenchErrors++;
+		}
+		BenchCount[0]++;
+	}
+}
+
+//Notification: the worker notifies itself and takes the notification, the direct-to-task
+//counterpart of the synchronization test
+static void Notification_Loop(void)
+{
+	int task = CurrentTask->task;
+	while(1)
+	{
+		xTaskNotifyGive(task);
+		ulTaskNotifyTake(true, WAIT_FOREVER);
+		BenchCount[0]++;
+	}
+}
+
+//Records the latency from the give timestamped in BenchWakeStamp to the woken task running
+static void benchWakeRecord(BenchWake* wake)
+{
+	uint32_t latency = portCycleCount() - BenchWakeStamp;
+	wake->samples++;
+	wake->total += latency;
+	if(latency > wake->max)
+	{
+		wake->max = latency;
+	}
+}
+
+//Wake latency, woken task: waits on the semaphore, then on a notification, and measures each wake.
+//It has the higher priority, so every give switches to it at once.
+static void WakeWaiter_Loop(void)
+{
+	while(1)
+	{
+		xSemaphoreTake(&BenchSignal);
+		benchWakeRecord(&BenchWakeSemaphore);
+		if(ulTaskNotifyTake(true, WAIT_FOREVER) != 1)
+		{
+			BenchErrors++;
+		}
+		benchWakeRecord(&BenchWakeNotification);
+	}
+}
+
+//Wake latency, giving task: gives the semaphore, then the notification, the waiter is blocked on
+//each of them in turn
+static void WakeGiver_Loop(void)
+{
+	while(1)
+	{
+		BenchWakeStamp = portCycleCount();
+		xSemaphoreGive(&BenchSignal);
+		BenchWakeStamp = portCycleCount();
+		xTaskNotifyGive(BENCH_FIRST_WORKER+1);
+		BenchCount[0]++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+// -- 										TESTS											   -- //
+//------------------------------------------------------------------------------------------------//
+//Create worker i of a test
+static void benchCreate(int i, void (*funct)(), int32_t priority)
+{
+	CreateTask(BENCH_FIRST_WORKER+i, funct, BenchStacks[i+1], BENCH_STACK_WORDS, priority);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: benchSetup
+//*DESCRIPTION: Creates the kernel objects and workers of a test. Run by the reporting task, which
+//*every worker has a lower priority than, so no worker runs before the first window starts.
+//*INPUTS: test (BENCH_ test number)
+//*OUTPUTS: Name of the test
+//------------------------------------------------------------------------------------------------//
+static const char* benchSetup(int test)
+{
+	switch(test)
+	{
+	case BENCH_COOPERATIVE:
+		for(int i = 0; i < BENCH_WORKERS; i++)
+		{
+			benchCreate(i, Cooperative_Loop, 5);
+		}
+		return "cooperative scheduling";
+	case BENCH_PREEMPTIVE:
+		for(int i = 0; i < BENCH_WORKERS; i++)
+		{
+			benchCreate(i, Preemptive_Loop, 10-i); //worker 4 has the highest priority
+		}
+		return "preemptive scheduling";
+	case BENCH_INTERRUPT:
+		initSemaphoreSignal(&BenchSignal, 1);
+		benchInitInterrupt(Interrupt_Handler);
+		benchCreate(0, Interrupt_Loop, 5);
+		return "interrupt processing";
+	case BENCH_INTERRUPT_PREEMPTION:
+		initSemaphoreSignal(&BenchSignal, 1);
+		benchInitInterrupt(Preemption_Handler);
+		benchCreate(0, Preemption_Loop, 6);
+		benchCreate(1, Preemption_Loop, 5);
+		return "interrupt preemption processing";
+	case BENCH_MESSAGE:
+		initQueue(&BenchQueue, BenchQueueStorage, sizeof(BenchQueueStorage[0]), 2);
+		benchCreate(0, Message_Loop, 5);
+		return "message processing";
+	case BENCH_SYNCHRONIZATION:
+		initSemaphoreBinary(&BenchSemaphore, 1);
+		benchCreate(0, Synchronization_Loop, 5);
+		return "synchronization processing";
+	case BENCH_MEMORY:
+		initBlockPool(&BenchPool, BenchPoolStorage, BENCH_BLOCK_BYTES, 2);
+		benchCreate(0, Memory_Loop, 5);
+		return "memory allocation";
+	case BENCH_MAILBOX:
+		initMailbox(&BenchBox, 0);
+		benchCreate(0, Mailbox_Loop, 5);
+		return "mailbox processing";
+	case BENCH_NOTIFICATION:
+		benchCreate(0, Notification_Loop, 5);
+		return "notification processing";
+	case BENCH_MAILBOX_BASELINE:
+		baselineInitMailbox(&BenchBaselineBox);
+		benchCreate(0, MailboxBaseline_Loop, 5);
+		return "mailbox processing, original mailbox";
+	case BENCH_WAKE_LATENCY:
+		initSemaphoreSignal(&BenchSignal, 1);
+		benchCreate(0, WakeGiver_Loop, 6);
+		benchCreate(1, WakeWaiter_Loop, 5);
+		return "give -> wake latency, semaphore and notification";
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: benchReportLatency
+//*DESCRIPTION: Reports every latency histogram the test recorded samples into, one line per
+//*histogram listing the samples of each power of 2 bucket up to the longest latency
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void benchReportLatency(void)
+{
+	static const char* names[LATENCY_KINDS] = {"interrupt", "release", "semaphore"};
+	char line[96];
+	for(int kind = 0; kind < LATENCY_KINDS; kind++)
+	{
+		xLatencyHistogram histogram;
+		vLatencyHistogramRead(kind, &histogram, false);
+		if(histogram.samples == 0)
+		{
+			continue;
+		}
+		snprintf(line, sizeof(line), "  %s latency: %lu samples, max %lu cycles, log2 buckets:",
+				 names[kind], (unsigned long)histogram.samples, (unsigned long)histogram.max);
+		benchPuts(line);
+		int last = LATENCY_BUCKETS-1;
+		while(histogram.bucket[last] == 0)
+		{
+			last--;
+		}
+		for(int b = 0; b <= last; b++)
+		{
+			snprintf(line, sizeof(line), " %lu", (unsigned long)histogram.bucket[b]);
+			benchPuts(line);
+		}
+		benchPuts("\n");
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: benchReportWake
+//*DESCRIPTION: Reports the give -> wake latencies of the semaphore and of the notification side
+//*by side, if the test measured any
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void benchReportWake(void)
+{
+	static const char* names[2] = {"semaphore", "notification"};
+	BenchWake* wakes[2] = {&BenchWakeSemaphore, &BenchWakeNotification};
+	char line[96];
+	for(int i = 0; i < 2; i++)
+	{
+		if(wakes[i]->samples == 0)
+		{
+			continue;
+		}
+		snprintf(line, sizeof(line), "  %-12s give -> wake: average %lu, max %lu cycles\n", names[i],
+				 (unsigned long)(wakes[i]->total / wakes[i]->samples), (unsigned long)wakes[i]->max);
+		benchPuts(line);
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: Reporter_Loop
+//*DESCRIPTION: Reporting task. Sets up the test, then reports the operations completed by every
+//*worker and interrupt within each window, the average over all windows and any errors.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void Reporter_Loop(void)
+{
+	char line[96];
+	const char* name = benchSetup(BenchTest);
+	snprintf(line, sizeof(line), "myRTOS benchmark %d: %s, %d tick windows\n", BenchTest, name,
+			 BENCH_WINDOW_TICKS);
+	benchPuts(line);
+
+	uint32_t last = 0;
+	uint32_t sum = 0;
+	int release_time = (int)SystemTick + BENCH_WINDOW_TICKS;
+	for(int window = 1; window <= BENCH_WINDOWS; window++)
+	{
+		vTaskDelayUntil(&release_time, BENCH_WINDOW_TICKS);
+		uint32_t total = 0;
+		for(int i = 0; i <= BENCH_WORKERS; i++)
+		{
+			total += BenchCount[i];
+		}
+		snprintf(line, sizeof(line), "  window %d: %lu\n", window, (unsigned long)(total - last));
+		benchPuts(line);
+		sum += total - last;
+		last = total;
+	}
+	snprintf(line, sizeof(line), "  average: %lu operations per window, %lu errors\n",
+			 (unsigned long)(sum / BENCH_WINDOWS), (unsigned long)BenchErrors);
+	benchPuts(line);
+	benchReportLatency();
+	benchReportWake();
+	benchExit(BenchErrors != 0);
+	while(1)
+	{
+		ulTaskNotifyTake(true, WAIT_FOREVER); //targets without an exit stop here
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: benchMain
+//*DESCRIPTION: Starts the kernel and the reporting task of a test, then continues as the idle loop.
+//*Called from the target glue's main in place of the application.
+//*INPUTS: test (BENCH_ test number)
+//*OUTPUTS: Non-zero if the test is unknown or the tick cannot be started
+//------------------------------------------------------------------------------------------------//
+int benchMain(int test)
+{
+	if(test < 1 || test > BENCH_TESTS)
+	{
+		return 1;
+	}
+	BenchTest = test;
+
+	//RTOS VARS INIT
+	CurrentTask = TCB;
+	SystemTick = 0;
+	idle_count = 0;
+	if(initSystemTick(SystemCoreClock/BENCH_TICK_HZ))
+	{
+		return 1;
+	}
+	CreateTask(BENCH_REPORTER, Reporter_Loop, BenchStacks[0], BENCH_STACK_WORDS, 0);
+
+	/* Infinite loop for aperiodic and sporadic tasks */
+	while(1)
+	{
+		idle_count++;
+	}
+}
@@ -0,0 +1,54 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Benchmark Suite
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* bench.h is the interface between the Thread-Metric style benchmark suite (bench.c) and the
+*  glue of the target it runs on (bench_posix.c, bench_qemu.c, bench_efm32gg.c). One test runs
+*  per program run: its tasks count completed operations and a reporting task prints the count
+*  of every BENCH_WINDOW_TICKS window, so results compare between kernel changes.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+
+#ifndef BENCH_WINDOW_TICKS
+#define BENCH_WINDOW_TICKS 1000 //SystemTicks per reported window (1s at a 1ms tick)
+#endif
+#ifndef BENCH_WINDOWS
+#define BENCH_WINDOWS 3 //Windows reported before the run ends
+#endif
+#define BENCH_TICK_HZ 1000 //SystemTick rate
+
+//Tests (program argument on the host and QEMU, BENCH_TEST on the board)
+#define BENCH_COOPERATIVE 1			//5 equal priority tasks, count and vTaskYield
+#define BENCH_PREEMPTIVE 2			//5 tasks, each resumes the next higher priority one
+#define BENCH_INTERRUPT 3			//task causes an interrupt, ISR gives a semaphore back
+#define BENCH_INTERRUPT_PREEMPTION 4 //ISR resumes a task of higher priority than the interrupted one
+#define BENCH_MESSAGE 5				//16 byte message sent and received through an xQueue
+#define BENCH_SYNCHRONIZATION 6		//xSemaphoreTake and xSemaphoreGive
+#define BENCH_MEMORY 7				//128 byte block allocated and freed
+#define BENCH_MAILBOX 8				//value written and read through a mailbox
+#define BENCH_NOTIFICATION 9		//xTaskNotifyGive and ulTaskNotifyTake (compare with 6)
+#define BENCH_MAILBOX_BASELINE 10	//test 8 through the original two semaphore mailbox (compare with 8)
+#define BENCH_WAKE_LATENCY 11		//give -> wake latency of another task, semaphore and notification
+#define BENCH_TESTS 11
+
+//------------------------------------------------------------------------------------------------//
+// -- 								FUNCTION PROTOTYPES 									   -- //
+//------------------------------------------------------------------------------------------------//
+//*NOTE: See Function Definitions in bench.c for Complete Description
+int benchMain(int test);					//Run one test, never returns unless the test is unknown
+
+//Target glue
+void benchInitInterrupt(void (*handler)(void)); //Install the interrupt the interrupt tests cause
+void benchCauseInterrupt(void);				//Pend that interrupt, taken before returning
+void benchPuts(const char* text);			//Report a line of results
+void benchExit(int status);					//End the run, status 0 == no errors
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,76 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Benchmark Glue, EFM32GG Board
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* Runs the benchmark suite on the EFM32 Giant Gecko. Build it in place of src/main.c, adding
+*  bench/bench.c and this file to the project with NUM_TASKS=7 and BENCH_TEST=<test number>
+*  defined. The interrupt is the unused AES interrupt pended through the NVIC. Results are kept
+*  in BenchLog, read it with the debugger once the run has stopped.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include <string.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "port.h"
+#include "myRTOS.h"
+#include "bench.h"
+
+#ifndef BENCH_TEST
+#define BENCH_TEST BENCH_COOPERATIVE //Test to run
+#endif
+
+char BenchLog[1024];				//Reported results, dump this symbol with the debugger
+static uint32_t BenchLogLength;		//Characters held by BenchLog
+volatile int BenchStatus = -1;		//-1 while running, then 0 == no errors
+static void (*BenchHandler)(void);	//Handler installed by benchInitInterrupt
+
+void AES_IRQHandler(void)
+{
+	BenchHandler();
+}
+
+void benchInitInterrupt(void (*handler)(void))
+{
+	BenchHandler = handler;
+	NVIC_EnableIRQ(AES_IRQn);
+}
+
+void benchCauseInterrupt(void)
+{
+	NVIC_SetPendingIRQ(AES_IRQn);
+	__DSB();
+	__ISB(); //taken here unless interrupts are disabled
+}
+
+void benchPuts(const char* text)
+{
+	uint32_t length = strlen(text);
+	if(BenchLogLength + length < sizeof(BenchLog)) //drop what does not fit
+	{
+		memcpy(&BenchLog[BenchLogLength], text, length + 1);
+		BenchLogLength += length;
+	}
+}
+
+void benchExit(int status)
+{
+	__disable_irq();
+	BenchStatus = status;
+	while(1); //break here and read BenchLog
+}
+
+int main(void)
+{
+	// Vendor function to work around bugs in some versions of the hardware
+	CHIP_Init();
+
+	//SYSTEM CLOCK CONFIGURATION
+	SystemCoreClock = 14000000; // 14 MHz for this device
+	benchMain(BENCH_TEST);
+	while(1);
+}
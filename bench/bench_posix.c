@@ -0,0 +1,55 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Benchmark Glue, POSIX Host Port
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* Runs the benchmark suite on the POSIX host port (make -C port/posix bench-run). The test number
+*  is the program argument, the interrupt is the port's emulated SIGUSR1 interrupt and results
+*  are printed to stdout.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "bench.h"
+
+void benchInitInterrupt(void (*handler)(void))
+{
+	portInitInterrupt(handler);
+}
+
+void benchCauseInterrupt(void)
+{
+	portCauseInterrupt();
+}
+
+void benchPuts(const char* text)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq(); //stdio is not reentrant, keep every task and interrupt out
+	fputs(text, stdout);
+	fflush(stdout);
+	__set_PRIMASK(primask);
+}
+
+void benchExit(int status)
+{
+	portStopTick();
+	__disable_irq();
+	exit(status);
+}
+
+int main(int argc, char** argv)
+{
+	int test = (argc > 1) ? atoi(argv[1]) : BENCH_COOPERATIVE;
+	if(benchMain(test))
+	{
+		fprintf(stderr, "usage: %s [test 1-%d]\n", argv[0], BENCH_TESTS);
+	}
+	return 1;
+}
@@ -0,0 +1,66 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Benchmark Glue, QEMU lm3s6965evb Port
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* Runs the benchmark suite on the QEMU lm3s6965evb port (make -C port/qemu-lm3s6965 bench-run).
+*  The test number is the last word of the semihosting command line (QEMU -append), the
+*  interrupt is IRQ 0 pended through the NVIC and results are printed over semihosting.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include <stdlib.h>
+#include <string.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "bench.h"
+#include "semihost.h"
+
+static void (*BenchHandler)(void); //Handler installed by benchInitInterrupt
+
+void GPIOA_IRQHandler(void)
+{
+	BenchHandler();
+}
+
+void benchInitInterrupt(void (*handler)(void))
+{
+	BenchHandler = handler;
+	NVIC_EnableIRQ(GPIOA_IRQn);
+}
+
+void benchCauseInterrupt(void)
+{
+	NVIC_SetPendingIRQ(GPIOA_IRQn);
+	__DSB();
+	__ISB(); //taken here unless interrupts are disabled
+}
+
+void benchPuts(const char* text)
+{
+	semihostPuts(text);
+}
+
+void benchExit(int status)
+{
+	semihostExit(status);
+}
+
+int main(void)
+{
+	char cmdline[64];
+	int test = BENCH_COOPERATIVE;
+	if(semihostCommandLine(cmdline, sizeof(cmdline)) == 0)
+	{
+		char* word = strrchr(cmdline, ' ');
+		test = atoi((word != 0) ? word + 1 : cmdline);
+	}
+	if(benchMain(test))
+	{
+		semihostPuts("usage: -append <test number>\n");
+	}
+	return 1;
+}
@@ -0,0 +1,113 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Scheduler Benchmark
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* sched_bench.c compares the ready bitmap scheduler with the linear TCB scan it replaced, at the
+*  task count the program is built with (make -C port/posix sched-bench-run builds it with
+*  NUM_TASKS 4, 32 and 256). Every task delays until a far release, so on each tick nothing is
+*  due: the common case, in which the linear scan checked every task. Two costs are reported in
+*  nanoseconds (timed with portCycleCount), averaged over SCHED_BENCH_CALLS calls:
+*    pick  choosing the next task (scheduler() against the original loop)
+*    tick  a SystemTick with nothing released (TickIncrement against SystemTick++ and the loop)
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include <stdio.h>
+#include "port.h"
+#include "myRTOS.h"
+
+#define SCHED_BENCH_CALLS 1000000	//calls timed per measurement
+#define SCHED_BENCH_STACK_WORDS 8192 //host frames need far more stack than the board
+#define SCHED_BENCH_RELEASE (1 << 30) //release of every task, never reached by the benchmark
+
+static uint32_t Stacks[NUM_TASKS][SCHED_BENCH_STACK_WORDS];
+static volatile uintptr_t Sink; //keeps the measured calls from being optimized away
+
+//Delays until a release the benchmark never reaches
+static void delayedTask(void)
+{
+	int release = SCHED_BENCH_RELEASE;
+	while(1)
+	{
+		vTaskDelayUntil(&release, SCHED_BENCH_RELEASE);
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: linearScheduler
+//*DESCRIPTION: The scheduler this kernel replaced: the first released, unblocked task in TCB order
+//*INPUTS: N/A
+//*OUTPUTS: Address of the task to be scheduled
+//------------------------------------------------------------------------------------------------//
+static __attribute__((noinline)) TaskControlBlock* linearScheduler(void)
+{
+	for (int i = 1; i < NUM_TASKS; i++)
+	{
+		if (SystemTick >= (uint32_t)TCB[i].suspend && TCB[i].blocked == 0)
+		{
+			return TCB+i;
+		}
+	}
+	return TCB;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: report
+//*DESCRIPTION: Prints one measurement as nanoseconds per call with two decimals
+//*INPUTS: name of the measurement, cycles taken by SCHED_BENCH_CALLS calls
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void report(const char* name, uint32_t cycles)
+{
+	uint64_t hundredths = (uint64_t)cycles * 100000000000u / SystemCoreClock / SCHED_BENCH_CALLS;
+	printf("  %-18s %6u.%02u ns\n", name, (unsigned)(hundredths / 100), (unsigned)(hundredths % 100));
+}
+
+int main(void)
+{
+	CurrentTask = TCB;
+	SystemTick = 0;
+	if(initSystemTick(SystemCoreClock/1000))
+	{
+		fprintf(stderr, "cannot start the tick\n");
+		return 1;
+	}
+	portStopTick(); //SystemTick only advances through the measured TickIncrement calls
+	for(int task = 1; task < NUM_TASKS; task++)
+	{
+		CreateTask(task, delayedTask, Stacks[task], SCHED_BENCH_STACK_WORDS, task % MAX_PRIORITIES);
+	}
+	__disable_irq();
+
+	printf("myRTOS scheduler benchmark, %d tasks\n", NUM_TASKS);
+	uint32_t start = portCycleCount();
+	for(int i = 0; i < SCHED_BENCH_CALLS; i++)
+	{
+		Sink += (uintptr_t)linearScheduler();
+	}
+	report("pick, linear scan", portCycleCount() - start);
+	start = portCycleCount();
+	for(int i = 0; i < SCHED_BENCH_CALLS; i++)
+	{
+		Sink += (uintptr_t)scheduler();
+	}
+	report("pick, bitmap", portCycleCount() - start);
+	start = portCycleCount();
+	for(int i = 0; i < SCHED_BENCH_CALLS; i++)
+	{
+		SystemTick++;
+		Sink += (uintptr_t)linearScheduler();
+	}
+	report("tick, linear scan", portCycleCount() - start);
+	start = portCycleCount();
+	for(int i = 0; i < SCHED_BENCH_CALLS; i++)
+	{
+		Sink += (uintptr_t)TickIncrement();
+	}
+	report("tick, delta queue", portCycleCount() - start);
+	return 0;
+}
@@ -0,0 +1,160 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - POSIX Host Demo
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* Host counterpart of src/main.c. Three periodic tasks share a semaphore and feed a mailbox
+*  reader for RUN_TICKS SystemTicks, then the idle loop stops the tick and prints each task's
+*  CPU utilization, context switches, stack high-water mark and deadline misses, and the latency
+*  histograms.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#include <stdio.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "myTrace.h"
+
+#define STACK_WORDS 16384 //host frames (and signal delivery) need far more stack than the board
+#define RUN_TICKS 2000	  //SystemTicks (ms) the demo runs for
+#define WORK_CYCLES 20000 //cycles of busy work per job (200us)
+
+//Task Stacks
+uint32_t stack1[STACK_WORDS]; //task A
+uint32_t stack2[STACK_WORDS]; //task B
+uint32_t stack3[STACK_WORDS]; //task C
+uint32_t stack4[STACK_WORDS]; //task D
+
+//Task Periods (in milliseconds)
+static int A_Delay = 5;
+static int B_Delay = 20;
+static int D_Delay = 7;
+
+xSemaphore SemaphoreList[1]; //Semaphore shared by tasks B and D
+xMailbox boxC;				 //Mailbox from task A to task C
+
+//Job counts, read by the report
+static volatile int A_jobs, B_jobs, C_jobs, D_jobs;
+
+//Spin for the given number of emulated cycles
+static void busyWork(uint32_t cycles)
+{
+	uint32_t start = portCycleCount();
+	while(portCycleCount() - start < cycles);
+}
+
+void Task_A_Loop(void)
+{
+	int prev_release_time = 10;
+	while(1)
+	{
+		vTaskDelayUntil(&prev_release_time, A_Delay);
+		int job = ++A_jobs;
+		writeToBox(&boxC, &job); //release task C
+	}
+}
+
+void Task_B_Loop(void)
+{
+	int prev_release_time = 10;
+	while(1)
+	{
+		vTaskDelayUntil(&prev_release_time, B_Delay);
+		xSemaphoreTake(&SemaphoreList[0]);
+		busyWork(5*WORK_CYCLES);
+		B_jobs++;
+		xSemaphoreGive(&SemaphoreList[0]);
+	}
+}
+
+void Task_C_Loop(void)
+{
+	while(1)
+	{
+		int job;
+		readFromBox(&boxC, &job);
+		busyWork(WORK_CYCLES);
+		C_jobs++;
+	}
+}
+
+void Task_D_Loop(void)
+{
+	int prev_release_time = 10;
+	while(1)
+	{
+		vTaskDelayUntil(&prev_release_time, D_Delay);
+		xSemaphoreTake(&SemaphoreList[0]);
+		busyWork(WORK_CYCLES);
+		D_jobs++;
+		xSemaphoreGive(&SemaphoreList[0]);
+	}
+}
+
+int main(void)
+{
+	//RTOS VARS INIT
+	CurrentTask = TCB;
+	SystemTick = 0;
+	idle_count = 0;
+
+	if(initSystemTick(SystemCoreClock/1000)) //1ms SystemTick from SIGALRM
+	{
+		fprintf(stderr, "cannot start the tick\n");
+		return 1;
+	}
+	vTraceStart(TRACE_MODE_SNAPSHOT);
+
+	initSemaphoreBinary(SemaphoreList, 1);
+	initMailbox(&boxC, 0);
+
+	CreateTask(1, Task_A_Loop, stack1, STACK_WORDS, 1);
+	CreateTask(2, Task_B_Loop, stack2, STACK_WORDS, 4);
+	CreateTask(3, Task_C_Loop, stack3, STACK_WORDS, 2);
+	CreateTask(4, Task_D_Loop, stack4, STACK_WORDS, 3);
+	vRunTimeWindowStart();
+
+	//Idle loop until the demo has run its course
+	while(*(volatile uint32_t *)&SystemTick < RUN_TICKS)
+	{
+		idle_count++;
+		if((idle_count & STACK_SCAN_INTERVAL) == 0) {vTaskStackScan();}
+	}
+	portStopTick();
+	__disable_irq(); //tasks stay switched out, stdio is safe to use
+
+	static const char* names[NUM_TASKS] = {"idle", "A", "B", "C", "D"};
+	printf("%u ticks, jobs A %d B %d C %d D %d\n", (unsigned)SystemTick, A_jobs, B_jobs, C_jobs,
+		   D_jobs);
+	printf("task  cpu%%    switches  stack free (words)  deadline misses (skipped)\n");
+	for(int i = 0; i < NUM_TASKS; i++)
+	{
+		uint32_t switches;
+		uint32_t skipped;
+		uint32_t utilization = uxTaskGetUtilization(i, &switches);
+		uint32_t misses = uxTaskGetDeadlineMisses(i, &skipped);
+		printf("%-5s %3u.%02u %9u  %18u  %u (%u)\n", names[i], (unsigned)(utilization / 100),
+			   (unsigned)(utilization % 100), (unsigned)switches,
+			   (i == 0) ? 0u : (unsigned)uxTaskGetStackHighWaterMark(i), (unsigned)misses,
+			   (unsigned)skipped);
+	}
+	static const char* kinds[LATENCY_KINDS] = {"interrupt", "release", "semaphore"};
+	for(int kind = 0; kind < LATENCY_KINDS; kind++)
+	{
+		xLatencyHistogram histogram;
+		vLatencyHistogramRead(kind, &histogram, false);
+		printf("%s latency: %u samples, max %u cycles\n", kinds[kind], (unsigned)histogram.samples,
+			   (unsigned)histogram.max);
+		for(int b = 0; b < LATENCY_BUCKETS; b++)
+		{
+			if(histogram.bucket[b] != 0)
+			{
+				printf("  < %8u cycles %u\n", 1u << b, (unsigned)histogram.bucket[b]);
+			}
+		}
+	}
+	printf("%u trace records\n", (unsigned)TraceBuffer.head);
+	return 0;
+}
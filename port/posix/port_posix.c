@@ -0,0 +1,313 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - POSIX Host Port
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* port_posix.c runs myRTOS within a single Linux process. Each task is a ucontext on its own
+*  stack and main() continues as the idle loop (TCB[0]), just as on the board. The SIGALRM handler
+*  plays SysTick, calling TickIncrement, and portSwitch plays PendSV: it is run once an interrupt
+*  handler has finished, or by portEnableIrq once the caller unmasks interrupts, so every switch
+*  happens at the same points of the kernel code as on the Cortex-M3. Tasks must not call into
+*  non reentrant C library code (stdio, malloc) unless interrupts are masked.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include "port.h"
+#include "myRTOS.h"
+
+uint32_t SystemCoreClock = POSIX_CORE_CLOCK;	//Emulated core clock (Hz)
+volatile uint32_t PortPrimask;					//Emulated PRIMASK
+volatile uint32_t PortIpsr;						//Emulated IPSR
+volatile uint32_t PortExclusive;				//Emulated exclusive monitor
+volatile uint32_t PortExclusiveValue;			//Value loaded by the last __LDREXW
+
+extern uint32_t RunTimeStamp;					//portCycleCount() at the last context switch (myRTOS.c)
+
+static ucontext_t TaskContext[NUM_TASKS];		//Saved context of every task, TCB[0] is main()
+static void (*TaskEntry[NUM_TASKS])();			//Task handler each context starts in
+static sigset_t InterruptSignals;				//SIGALRM and SIGUSR1, the emulated interrupts
+static void (*InterruptHandler)(void);			//Handler of the SIGUSR1 interrupt
+static volatile uint32_t SwitchPending;			//Emulated PENDSVSET
+static struct timespec ClockStart;				//portCycleCount() == 0
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portSwitch
+//*DESCRIPTION: Emulated PendSV_Handler. Asks the scheduler for the next task, charges the cycles
+//*since the last switch to the outgoing task and swaps to the incoming task's context. Called
+//*with interrupts masked, returns once the outgoing task is switched back in.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void portSwitch(void)
+{
+	SwitchPending = 0;
+	PortExclusive = 0; //exception entry clears the exclusive monitor
+	TaskControlBlock* prev = (TaskControlBlock*)CurrentTask;
+	TaskControlBlock* next = scheduler();
+
+	//charge the cycles since the last switch to the outgoing task
+	uint32_t now = portCycleCount();
+	prev->runtime += now - RunTimeStamp;
+	RunTimeStamp = now;
+	next->switches++;
+	CurrentTask = next;
+	if(next != prev)
+	{
+		swapcontext(&TaskContext[prev->task], &TaskContext[next->task]);
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portInterruptHandler
+//*DESCRIPTION: Emulated SysTick_Handler (SIGALRM), see context.s, and peripheral interrupt
+//*(SIGUSR1). Advances SystemTick or runs the installed handler and, if a released task preempts
+//*or a FromISR call pended a switch, switches context on the way out.
+//*INPUTS: signal (SIGALRM or SIGUSR1)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void portInterruptHandler(int signal)
+{
+	int saved_errno = errno;
+	PortExclusive = 0;
+	if(signal == SIGALRM)
+	{
+		PortIpsr = POSIX_TICK_EXCEPTION;
+		PortPrimask = 1;
+		if(TickIncrement())
+		{
+			SwitchPending = 1;
+		}
+	}
+	else
+	{
+		PortIpsr = POSIX_IRQ_EXCEPTION;
+		PortPrimask = 0;
+		InterruptHandler();
+	}
+	PortIpsr = 0;
+	PortPrimask = 1;
+	while(SwitchPending)
+	{
+		portSwitch(); //tail-chained PendSV
+	}
+	PortPrimask = 0;
+	errno = saved_errno;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portTaskStart
+//*DESCRIPTION: First code run by a new task context. Tasks are switched in with interrupts masked,
+//*so it is unmasked before the task handler is entered. Task handlers never return.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void portTaskStart(void)
+{
+	portEnableIrq();
+	TaskEntry[CurrentTask->task]();
+	abort(); //a task returned, the board would fault on its zero link register
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portDisableIrq
+//*DESCRIPTION: Emulated cpsid i, blocks SIGALRM and SIGUSR1
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portDisableIrq(void)
+{
+	sigprocmask(SIG_BLOCK, &InterruptSignals, 0);
+	PortPrimask = 1;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portEnableIrq
+//*DESCRIPTION: Emulated cpsie i. A switch pended while interrupts were masked is taken first, as
+//*PendSV would be the moment interrupts are enabled. Within a handler only PRIMASK is
+//*cleared, the handler keeps interrupts blocked until it returns.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portEnableIrq(void)
+{
+	if(PortIpsr != 0)
+	{
+		PortPrimask = 0;
+		return;
+	}
+	if(SwitchPending)
+	{
+		portDisableIrq();
+		while(SwitchPending)
+		{
+			portSwitch();
+		}
+	}
+	PortPrimask = 0;
+	sigprocmask(SIG_UNBLOCK, &InterruptSignals, 0);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portInitStack
+//*DESCRIPTION: Creates the context a task starts in, running on the task's own stack memory so
+//*stack painting and high-water marks work as on the board. Host stack frames are far larger
+//*than Cortex-M3 ones, give tasks thousands of words.
+//*INPUTS: task (identifier), stack (task stack memory), stack_words (size of stack memory),
+//*funct (task handler)
+//*OUTPUTS: Top of the task stack (informational, the context lives in TaskContext)
+//------------------------------------------------------------------------------------------------//
+uint32_t* portInitStack(int task, void *stack, uint32_t stack_words, void (*funct)())
+{
+	getcontext(&TaskContext[task]);
+	TaskContext[task].uc_stack.ss_sp = stack;
+	TaskContext[task].uc_stack.ss_size = stack_words * sizeof(uint32_t);
+	TaskContext[task].uc_link = 0;
+	sigaddset(&TaskContext[task].uc_sigmask, SIGALRM); //switched in with interrupts masked
+	sigaddset(&TaskContext[task].uc_sigmask, SIGUSR1);
+	makecontext(&TaskContext[task], portTaskStart, 0);
+	TaskEntry[task] = funct;
+	return (uint32_t *)stack + stack_words;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portInitTick
+//*DESCRIPTION: Installs the SIGALRM tick handler and starts an interval timer firing every
+//*cycles_per_tick emulated cycles. The timer resolution of the host bounds the shortest tick.
+//*INPUTS: Emulated core clock cycles per SystemTick
+//*OUTPUTS: 0 on success, non-zero if the tick cannot be started
+//------------------------------------------------------------------------------------------------//
+int portInitTick(uint32_t cycles_per_tick)
+{
+	uint64_t usec = (uint64_t)cycles_per_tick * 1000000u / SystemCoreClock;
+	if(usec == 0)
+	{
+		return 1;
+	}
+	sigemptyset(&InterruptSignals);
+	sigaddset(&InterruptSignals, SIGALRM);
+	sigaddset(&InterruptSignals, SIGUSR1);
+	clock_gettime(CLOCK_MONOTONIC, &ClockStart);
+
+	struct sigaction action;
+	action.sa_handler = portInterruptHandler;
+	action.sa_mask = InterruptSignals;
+	action.sa_flags = SA_RESTART;
+	if(sigaction(SIGALRM, &action, 0))
+	{
+		return 1;
+	}
+	struct itimerval period;
+	period.it_interval.tv_sec = usec / 1000000u;
+	period.it_interval.tv_usec = usec % 1000000u;
+	period.it_value = period.it_interval;
+	return setitimer(ITIMER_REAL, &period, 0) != 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portStopTick
+//*DESCRIPTION: Stops the interval timer, e.g. before the host program reports and exits
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portStopTick(void)
+{
+	struct itimerval off = {{0, 0}, {0, 0}};
+	setitimer(ITIMER_REAL, &off, 0);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portStepTick
+//*DESCRIPTION: Raises the emulated SysTick exception by software. Host tests stop the interval
+//*timer (portStopTick) and step the tick from the idle loop, so every release happens at a known
+//*point of the test. Returns once the tick and any task it released have run.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portStepTick(void)
+{
+	raise(SIGALRM);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portInitInterrupt
+//*DESCRIPTION: Installs the handler of the emulated peripheral interrupt (SIGUSR1). Like the tick
+//*it is masked by __disable_irq and may call the FromISR kernel functions. Call after
+//*initSystemTick.
+//*INPUTS: handler (interrupt service routine)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portInitInterrupt(void (*handler)(void))
+{
+	InterruptHandler = handler;
+	struct sigaction action;
+	action.sa_handler = portInterruptHandler;
+	action.sa_mask = InterruptSignals;
+	action.sa_flags = SA_RESTART;
+	sigaction(SIGUSR1, &action, 0);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portCauseInterrupt
+//*DESCRIPTION: Emulated NVIC_SetPendingIRQ, the handler runs before this returns unless
+//*interrupts are masked, in which case it runs once they are enabled
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portCauseInterrupt(void)
+{
+	raise(SIGUSR1);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portPendSwitch
+//*DESCRIPTION: Emulated PENDSVSET. The switch is taken at once from a task with interrupts
+//*unmasked, otherwise when the interrupt handler returns or portEnableIrq runs.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void portPendSwitch(void)
+{
+	SwitchPending = 1;
+	if(PortIpsr == 0 && PortPrimask == 0)
+	{
+		portDisableIrq();
+		portEnableIrq();
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: Yield
+//*DESCRIPTION: Pends a context switch to the highest precedence ready task, see context.s
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void Yield(void)
+{
+	portPendSwitch();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portCycleCount
+//*DESCRIPTION: Emulated DWT->CYCCNT, monotonic clock time since portInitTick in cycles of
+//*POSIX_CORE_CLOCK
+//*INPUTS: N/A
+//*OUTPUTS: Emulated cycles (wraps at 2^32, about 43 seconds)
+//------------------------------------------------------------------------------------------------//
+uint32_t portCycleCount(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	uint64_t ns = (uint64_t)(now.tv_sec - ClockStart.tv_sec) * 1000000000u
+				  + (uint64_t)(now.tv_nsec - ClockStart.tv_nsec);
+	return (uint32_t)(ns / (1000000000u / POSIX_CORE_CLOCK));
+}
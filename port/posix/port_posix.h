@@ -0,0 +1,108 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - POSIX Host Port
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* port_posix.h lets myRTOS.c compile unmodified for Linux (x86-64 or any other host). Every task
+*  runs on its own ucontext within one process and SIGALRM, from an interval timer, stands in for
+*  SysTick, SIGUSR1 for a peripheral interrupt. PRIMASK is emulated by blocking both signals,
+*  PendSV by a switch pended until the emulated interrupts are enabled again, and the DWT cycle
+*  counter by the monotonic clock. Only the periodic tick is supported (TICKLESS 0).
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef PORT_POSIX_H_
+#define PORT_POSIX_H_
+
+#include <stdint.h>
+
+#ifndef TICKLESS
+#define TICKLESS 0 //only the periodic tick is emulated
+#elif TICKLESS
+#error "The POSIX port has no SysTick to reprogram, build with TICKLESS 0"
+#endif
+
+#define POSIX_CORE_CLOCK 100000000u //Emulated core clock (Hz), portCycleCount counts 10ns cycles
+#define POSIX_TICK_EXCEPTION 15		//__get_IPSR while the tick handler runs (SysTick_IRQn + 16)
+#define POSIX_IRQ_EXCEPTION 16		//__get_IPSR while the portInitInterrupt handler runs (IRQ 0)
+
+extern uint32_t SystemCoreClock;		//POSIX_CORE_CLOCK, for code shared with the board
+extern volatile uint32_t PortPrimask;	//Emulated PRIMASK: 1 == interrupts are masked
+extern volatile uint32_t PortIpsr;		//Emulated IPSR: 0 == task, else the running handler
+extern volatile uint32_t PortExclusive; //Emulated exclusive monitor: 1 == open
+extern volatile uint32_t PortExclusiveValue; //Value the open monitor was set by
+
+//------------------------------------------------------------------------------------------------//
+// -- 								FUNCTION PROTOTYPES 									   -- //
+//------------------------------------------------------------------------------------------------//
+//*NOTE: See Function Definitions in port_posix.c for Complete Description
+void portDisableIrq(void);				//Block interrupts
+void portEnableIrq(void);				//Run a pended switch, then unblock interrupts
+uint32_t* portInitStack(int task, void *stack, uint32_t stack_words, void (*funct)()); //Task context
+int portInitTick(uint32_t cycles_per_tick); //Start the SIGALRM tick
+void portStopTick(void);				//Stop the SIGALRM tick
+void portStepTick(void);				//Raise one tick by software (host tests)
+void portInitInterrupt(void (*handler)(void)); //Install the SIGUSR1 peripheral interrupt
+void portCauseInterrupt(void);			//Pend the SIGUSR1 interrupt
+void portPendSwitch(void);				//Pend a context switch
+uint32_t portCycleCount(void);			//Emulated cycle counter (wraps at 2^32)
+
+//CMSIS intrinsics used by the kernel
+#define __disable_irq() portDisableIrq()
+#define __enable_irq() portEnableIrq()
+#define __get_IPSR() (PortIpsr)
+#define __DSB()
+#define __ISB()
+
+static inline uint32_t __get_PRIMASK(void)
+{
+	return PortPrimask;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+	if(primask)
+	{
+		portDisableIrq();
+	}
+	else
+	{
+		portEnableIrq();
+	}
+}
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+	return (value == 0) ? 32 : (uint8_t)__builtin_clz(value);
+}
+
+//LDREX/STREX: the store succeeds if no tick or context switch closed the monitor in between and
+//the word still holds the loaded value, checked and stored atomically against interrupts
+static inline uint32_t __LDREXW(volatile uint32_t *addr)
+{
+	uint32_t value = *addr;
+	PortExclusiveValue = value;
+	PortExclusive = 1;
+	return value;
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+	uint32_t expected = PortExclusiveValue;
+	if(!PortExclusive)
+	{
+		return 1;
+	}
+	PortExclusive = 0;
+	return __atomic_compare_exchange_n(addr, &expected, value, 0, __ATOMIC_SEQ_CST,
+									   __ATOMIC_SEQ_CST) ? 0 : 1;
+}
+
+static inline void __CLREX(void)
+{
+	PortExclusive = 0;
+}
+
+#endif /* PORT_POSIX_H_ */
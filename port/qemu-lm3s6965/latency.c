@@ -0,0 +1,136 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - QEMU Interrupt Latency Benchmark
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* Interrupt latency benchmark of the QEMU lm3s6965evb port (make -C port/qemu-lm3s6965
+*  latency-run). The SysTick vector points at LatencyTick_Handler, which pends IRQ 0 (GPIOA) the
+*  moment SysTick is entered and then runs the kernel's SysTick_Handler. IRQ 0 has the priority of
+*  SysTick, as any interrupt calling the FromISR functions may, so it waits for everything the
+*  tick does: the cycles from the pend to its handler are the interrupt latency added by the tick.
+*  A periodic task is released every LATENCY_PERIOD ticks, so half of the ticks switch context.
+*  The handler gives a semaphore to a waiting task, whose wake is recorded in the
+*  LATENCY_INTERRUPT histogram. latency.elf is built with the PendSV design of context.s,
+*  latency_systick.elf with CM3_SWITCH_IN_SYSTICK 1, switching inside SysTick on every tick.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#include <stdio.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "semihost.h"
+
+#define LATENCY_TICKS 1000	//ticks measured
+#define LATENCY_PERIOD 2	//ticks between releases of the periodic task
+
+//Task Stacks
+uint32_t stack1[256]; //periodic task
+uint32_t stack2[256]; //interrupt task
+
+xSemaphore IrqSemaphore[1]; //Signalled by the IRQ 0 handler, taken by the interrupt task
+
+static volatile uint32_t PendValue;	//SysTick->VAL when IRQ 0 was pended
+static volatile uint32_t Samples;	//Latencies measured
+static volatile uint32_t Total;		//Sum of the latencies measured
+static volatile uint32_t Max;		//Longest latency measured
+
+void SysTick_Handler(void); //context.s
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: LatencyTick_Handler
+//*DESCRIPTION: SysTick vector of latency.elf (see startup.c), pends IRQ 0 and runs the tick
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void LatencyTick_Handler(void)
+{
+	PendValue = SysTick->VAL;
+	NVIC_SetPendingIRQ(GPIOA_IRQn);
+	SysTick_Handler();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: GPIOA_IRQHandler
+//*DESCRIPTION: IRQ 0, measures the cycles since it was pended and wakes the interrupt task. The
+//*latency is read from the SysTick down counter, which has not reloaded since the pend.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void GPIOA_IRQHandler(void)
+{
+	uint32_t latency = PendValue - SysTick->VAL;
+	if(Samples < LATENCY_TICKS)
+	{
+		Samples++;
+		Total += latency;
+		if(latency > Max)
+		{
+			Max = latency;
+		}
+	}
+	xSemaphoreGiveFromISR(&IrqSemaphore[0]);
+}
+
+//Released every LATENCY_PERIOD ticks, so the ticks releasing it switch context
+void Periodic_Loop(void)
+{
+	int release = SystemTick;
+	while(1)
+	{
+		vTaskDelayUntil(&release, LATENCY_PERIOD);
+	}
+}
+
+//Woken by every IRQ 0, reports once LATENCY_TICKS latencies were measured
+void Interrupt_Loop(void)
+{
+	char line[80];
+	xLatencyHistogram histogram;
+
+	while(Samples < LATENCY_TICKS)
+	{
+		xSemaphoreTake(&IrqSemaphore[0]);
+	}
+	NVIC_DisableIRQ(GPIOA_IRQn);
+	vLatencyHistogramRead(LATENCY_INTERRUPT, &histogram, false);
+
+	semihostPuts(CM3_SWITCH_IN_SYSTICK ? "switch in SysTick\n" : "switch in PendSV\n");
+	snprintf(line, sizeof(line), "%-44s %6lu cycles\n", "IRQ at SysTick priority, average",
+			 (unsigned long)(Total / Samples));
+	semihostPuts(line);
+	snprintf(line, sizeof(line), "%-44s %6lu cycles\n", "IRQ at SysTick priority, max",
+			 (unsigned long)Max);
+	semihostPuts(line);
+	snprintf(line, sizeof(line), "%-44s %6lu cycles\n", "IRQ give -> task running, max",
+			 (unsigned long)histogram.max);
+	semihostPuts(line);
+	semihostExit(0);
+}
+
+int main(void)
+{
+	//RTOS VARS INIT
+	CurrentTask = TCB;
+	SystemTick = 0;
+	idle_count = 0;
+
+	if(initSystemTick(SystemCoreClock/1000)) //1ms SystemTick
+	{
+		return 1;
+	}
+	NVIC_SetPriority(GPIOA_IRQn, NVIC_GetPriority(SysTick_IRQn));
+	NVIC_EnableIRQ(GPIOA_IRQn);
+
+	initSemaphoreSignal(IrqSemaphore, 1);
+
+	CreateTask(1, Periodic_Loop, stack1, 256, 1);
+	CreateTask(2, Interrupt_Loop, stack2, 256, 2);
+
+	/* Infinite loop for aperiodic and sporadic tasks */
+	while(1)
+	{
+		idle_count++;
+	}
+}
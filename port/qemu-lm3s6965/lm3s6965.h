@@ -0,0 +1,43 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - QEMU lm3s6965evb Device Header
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* lm3s6965.h is the minimal CMSIS device header port_cm3.h needs for the Stellaris LM3S6965
+*  (Cortex-M3) emulated by QEMU's lm3s6965evb machine: the exception numbers and core
+*  configuration, with every core peripheral (SysTick, SCB, NVIC) taken from CMSIS core_cm3.h.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef LM3S6965_H_
+#define LM3S6965_H_
+
+#include <stdint.h>
+
+typedef enum IRQn
+{
+	NonMaskableInt_IRQn = -14,
+	HardFault_IRQn = -13,
+	MemoryManagement_IRQn = -12,
+	BusFault_IRQn = -11,
+	UsageFault_IRQn = -10,
+	SVCall_IRQn = -5,
+	DebugMonitor_IRQn = -4,
+	PendSV_IRQn = -2,
+	SysTick_IRQn = -1,
+	GPIOA_IRQn = 0,
+	UART0_IRQn = 5
+} IRQn_Type;
+
+#define __CM3_REV 0x0101			//r1p1
+#define __MPU_PRESENT 1
+#define __NVIC_PRIO_BITS 3
+#define __Vendor_SysTickConfig 0
+
+#include "core_cm3.h"
+
+extern uint32_t SystemCoreClock;	//Core clock (Hz), see startup.c
+
+#endif /* LM3S6965_H_ */
@@ -0,0 +1,123 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - QEMU Kernel Path Benchmarks
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* Benchmark application of the QEMU lm3s6965evb port. A driver task times ITERATIONS runs of the
+*  Yield, semaphore and mailbox paths, with and without a context switch to a higher priority
+*  partner task, and reports the average cycles per operation over semihosting. Run under
+*  -icount the results are deterministic, so they can be compared between kernel changes.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#include <stdio.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "semihost.h"
+
+#define ITERATIONS 1000 //operations timed per benchmark
+
+//Task Stacks
+uint32_t stack1[256]; //partner task
+uint32_t stack2[256]; //driver task
+
+xSemaphore SemaphoreList[1];	//Uncontended binary semaphore
+xSemaphoreCounting PingSemaphore; //Driver gives, partner takes
+xMailbox boxDriver;				//Mailbox used by the driver alone
+xMailbox boxPartner;			//Mailbox from the driver to the partner
+
+//Report the average cycles of one operation
+static void report(const char* name, uint32_t cycles)
+{
+	char line[80];
+	snprintf(line, sizeof(line), "%-44s %6lu cycles\n", name, (unsigned long)(cycles / ITERATIONS));
+	semihostPuts(line);
+}
+
+//Higher priority partner, blocked on the semaphore and then the mailbox while the driver runs
+void Partner_Loop(void)
+{
+	for(int i = 0; i < ITERATIONS; i++)
+	{
+		xSemaphoreTakeCounting(&PingSemaphore);
+	}
+	while(1)
+	{
+		int x;
+		readFromBox(&boxPartner, &x);
+	}
+}
+
+void Driver_Loop(void)
+{
+	uint32_t start;
+	int x = 0;
+
+	start = portCycleCount();
+	for(int i = 0; i < ITERATIONS; i++)
+	{
+		Yield();
+	}
+	report("Yield, no switch (PendSV entry/exit)", portCycleCount() - start);
+
+	start = portCycleCount();
+	for(int i = 0; i < ITERATIONS; i++)
+	{
+		xSemaphoreTake(&SemaphoreList[0]);
+		xSemaphoreGive(&SemaphoreList[0]);
+	}
+	report("xSemaphoreTake + xSemaphoreGive", portCycleCount() - start);
+
+	start = portCycleCount();
+	for(int i = 0; i < ITERATIONS; i++)
+	{
+		writeToBox(&boxDriver, &x);
+		readFromBox(&boxDriver, &x);
+	}
+	report("writeToBox + readFromBox", portCycleCount() - start);
+
+	start = portCycleCount();
+	for(int i = 0; i < ITERATIONS; i++)
+	{
+		xSemaphoreGiveCounting(&PingSemaphore); //wakes the partner, which blocks again
+	}
+	report("semaphore handoff (give, 2 switches, take)", portCycleCount() - start);
+
+	start = portCycleCount();
+	for(int i = 0; i < ITERATIONS; i++)
+	{
+		writeToBox(&boxPartner, &x); //wakes the partner, which blocks again
+	}
+	report("mailbox handoff (write, 2 switches, read)", portCycleCount() - start);
+
+	semihostExit(0);
+}
+
+int main(void)
+{
+	//RTOS VARS INIT
+	CurrentTask = TCB;
+	SystemTick = 0;
+	idle_count = 0;
+
+	if(initSystemTick(SystemCoreClock/1000)) //1ms SystemTick
+	{
+		return 1;
+	}
+
+	initSemaphoreBinary(SemaphoreList, 1);
+	initSemaphoreCounting(&PingSemaphore, 0, ITERATIONS);
+	initMailbox(&boxDriver, 0);
+	initMailbox(&boxPartner, 0);
+
+	CreateTask(1, Partner_Loop, stack1, 256, 1); //runs at once and blocks on PingSemaphore
+	CreateTask(2, Driver_Loop, stack2, 256, 2);
+
+	/* Infinite loop for aperiodic and sporadic tasks */
+	while(1)
+	{
+		idle_count++;
+	}
+}
@@ -0,0 +1,24 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - QEMU Semihosting
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* semihost.h is the ARM semihosting interface the QEMU port reports results through. QEMU
+*  services the calls when started with -semihosting-config enable=on,target=native.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef SEMIHOST_H_
+#define SEMIHOST_H_
+
+#include <stdint.h>
+
+//*NOTE: See Function Definitions in startup.c for Complete Description
+void semihostPuts(const char* text);	//Write a string to the host console
+void semihostExit(int status);			//Stop the emulator, 0 == success
+int semihostCommandLine(char* buffer, int size); //Read the program's command line
+uint32_t cm3CycleCount(void);			//portCycleCount for context.s (CM3_NO_DWT)
+
+#endif /* SEMIHOST_H_ */
@@ -0,0 +1,161 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - QEMU lm3s6965evb Startup
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* startup.c holds the vector table and reset handler of the QEMU lm3s6965evb port, together with
+*  the semihosting calls results are reported through. SysTick_Handler and PendSV_Handler are the
+*  board's, from context.s. QEMU models no DWT, so the port is built with CM3_NO_DWT 1.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include "port.h"
+#include "myRTOS.h"
+#include "semihost.h"
+
+#if !CM3_NO_DWT || TICKLESS
+#error "QEMU has no DWT cycle counter, build with CM3_NO_DWT 1 and TICKLESS 0"
+#endif
+
+#define SYS_WRITE0 0x04					//Semihosting: write a null terminated string
+#define SYS_GET_CMDLINE 0x15			//Semihosting: read the command line
+#define SYS_EXIT 0x18					//Semihosting: stop the application
+#define ADP_STOPPED_APPLICATION_EXIT 0x20026 //SYS_EXIT reason, exit status 0
+#define ADP_STOPPED_RUN_TIME_ERROR 0x20023	 //SYS_EXIT reason, exit status 1
+
+uint32_t SystemCoreClock = 12000000;	//lm3s6965evb reset clock (12 MHz), also clocks SysTick
+
+//Linker script symbols
+extern uint32_t _sidata, _sdata, _edata, _sbss, _ebss, _estack;
+
+int main(void);
+void Reset_Handler(void);
+void Fault_Handler(void);
+void SysTick_Handler(void);				//context.s
+void PendSV_Handler(void);				//context.s
+void GPIOA_IRQHandler(void) __attribute__((weak, alias("Fault_Handler"))); //IRQ 0, see bench_qemu.c
+
+#ifndef SYSTICK_VECTOR
+#define SYSTICK_VECTOR SysTick_Handler	//latency.elf wraps it with LatencyTick_Handler (latency.c)
+#endif
+void SYSTICK_VECTOR(void);
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: semihostCall
+//*DESCRIPTION: Traps to the debugger (QEMU) with a semihosting operation
+//*INPUTS: op (operation number), arg (operation argument)
+//*OUTPUTS: Operation result
+//------------------------------------------------------------------------------------------------//
+static int semihostCall(int op, void* arg)
+{
+	register int r0 __asm__("r0") = op;
+	register void* r1 __asm__("r1") = arg;
+	__asm__ volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+	return r0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: semihostPuts
+//*DESCRIPTION: Writes a string to the host console
+//*INPUTS: Null terminated string
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void semihostPuts(const char* text)
+{
+	semihostCall(SYS_WRITE0, (void*)text);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: semihostCommandLine
+//*DESCRIPTION: Reads the command line QEMU was given for the program, the kernel file name
+//*followed by the -append string
+//*INPUTS: Buffer for the command line, size of the buffer
+//*OUTPUTS: 0 on success, non-zero if there is no command line
+//------------------------------------------------------------------------------------------------//
+int semihostCommandLine(char* buffer, int size)
+{
+	struct {
+		char* buffer;
+		int size;
+	} block = {buffer, size};
+	return semihostCall(SYS_GET_CMDLINE, &block);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: semihostExit
+//*DESCRIPTION: Stops the emulator, QEMU exits with status 0 on success and 1 otherwise
+//*INPUTS: status (0 == success)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void semihostExit(int status)
+{
+	semihostCall(SYS_EXIT, (void*)(status == 0 ? ADP_STOPPED_APPLICATION_EXIT
+											   : ADP_STOPPED_RUN_TIME_ERROR));
+	while(1);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: cm3CycleCount
+//*DESCRIPTION: portCycleCount for context.s, which cannot call the inline function
+//*INPUTS: N/A
+//*OUTPUTS: SysTick cycles (wraps at 2^32)
+//------------------------------------------------------------------------------------------------//
+uint32_t cm3CycleCount(void)
+{
+	return portCycleCount();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: Reset_Handler
+//*DESCRIPTION: Copies .data from flash, clears .bss and runs main, which continues as the idle loop
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void Reset_Handler(void)
+{
+	uint32_t *src = &_sidata;
+	for(uint32_t *dst = &_sdata; dst < &_edata; dst++)
+	{
+		*dst = *src++;
+	}
+	for(uint32_t *dst = &_sbss; dst < &_ebss; dst++)
+	{
+		*dst = 0;
+	}
+	semihostExit(main());
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: Fault_Handler
+//*DESCRIPTION: Every other exception, reports it and stops the emulator with a failure status
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void Fault_Handler(void)
+{
+	semihostPuts("unexpected exception\n");
+	semihostExit(1);
+}
+
+//Vector table, placed at address 0 by lm3s6965.ld
+__attribute__((section(".isr_vector"), used))
+void (* const VectorTable[17])(void) =
+{
+	(void (*)(void))&_estack,	//Initial main stack pointer
+	Reset_Handler,
+	Fault_Handler,				//NMI
+	Fault_Handler,				//HardFault
+	Fault_Handler,				//MemManage
+	Fault_Handler,				//BusFault
+	Fault_Handler,				//UsageFault
+	0, 0, 0, 0,
+	Fault_Handler,				//SVCall
+	Fault_Handler,				//DebugMonitor
+	0,
+	PendSV_Handler,
+	SYSTICK_VECTOR,
+	GPIOA_IRQHandler			//IRQ 0
+};
@@ -10,44 +10,77 @@
     .align      4
     .globl      SysTick_Handler
     .type       SysTick_Handler, %function
-    .globl      SVC_Handler
-    .type       SVC_Handler, %function
+    .globl      PendSV_Handler
+    .type       PendSV_Handler, %function
     .globl      Yield
     .type       Yield, %function
 
+//SysTick only does the tick bookkeeping and pends PendSV when a released task should preempt,
+//leaving the context switch to the lowest priority so higher priority interrupts are never
+//delayed by it. On most ticks nothing is released and no task context is saved at all.
+//CM3_SWITCH_IN_SYSTICK 1 builds the original design instead, switching inside SysTick on every
+//tick, for the interrupt latency benchmark of port/qemu-lm3s6965 (latency.c).
 SysTick_Handler:
-    push   {r4-r11, lr}
+    push   {r4, lr}        //r4 keeps the stack 8 byte aligned
 
-    //increment system tick
-    ldr    r6,=SystemTick  // r6 is the address of the current task
-    ldr	   r7,[r6]  	   // r7 is the current tick
-    add	   r7,r7,#1		   // increment tick count
-    str    r7,[r6]   	   // store tick count
+    //increment system tick and release any delayed tasks that are due
+    cpsid  i               //the kernel lists are shared with FromISR calls
+    bl     TickIncrement
+    cpsie  i
+#if CM3_SWITCH_IN_SYSTICK
+    pop    {r4, lr}
+    b      PendSV_Handler  //switch at SysTick priority, returning from SysTick
+#endif
+    cbz    r0, 1f          //fast path: the current task keeps running
 
-    //set the new current task
-    ldr    r4,=CurrentTask // r4 is address of current task
-    ldr    r5,[r4]         // r5 is current task
-    str    sp,[r5,#0]      // stack pointer is first thing in TCB
-    bl     scheduler
-    str    r0,[r4]         // save new CurrentTask
-    ldr    sp,[r0,#0]      // get sp from new current task
+    ldr    r0,=0xE000ED04  // r0 is address of SCB->ICSR
+    ldr    r1,=0x10000000  // PENDSVSET
+    str    r1,[r0]         // pend the context switch
+1:
+    pop    {r4, pc}
 
-    pop    {r4-r11, pc}
-
-//This handler mimics the SysTick_Handler however when called it doesn't increment the SystemTick
-SVC_Handler:
+//Lowest priority handler performing every context switch. It is pended by SysTick, Yield and the
+//FromISR kernel calls, and nested interrupts tail-chain into it once they have all returned
+PendSV_Handler:
     push   {r4-r11, lr}    //store all current task info
     ldr    r4,=CurrentTask // r4 is address of current task
     ldr    r5,[r4]         // r5 is current task
     str    sp,[r5,#0]      // stack pointer is first thing in TCB
-  	bl     scheduler	   // call the scheduler
-    str    r0,[r4]         // save new CurrentTask
-    ldr    sp,[r0,#0]      // get sp from new current task
+    cpsid  i               //the kernel lists are shared with FromISR calls
+    bl     scheduler       // call the scheduler
+    mov    r6, r0          // r6 is the new current task
+
+    //charge the cycles since the last switch to the outgoing task
+#if CM3_NO_DWT
+    bl     cm3CycleCount   // no DWT on this core, count SysTick cycles (port_cm3.h)
+    mov    r2, r0          // r2 is the cycle count now
+#else
+    ldr    r1,=0xE0001004  // r1 is address of DWT->CYCCNT
+    ldr    r2,[r1]         // r2 is the cycle count now
+#endif
+    ldr    r1,=RunTimeStamp
+    ldr    r3,[r1]         // r3 is the cycle count at the last switch
+    str    r2,[r1]         // stamp this switch
+    subs   r2,r2,r3        // cycles the outgoing task ran
+    ldr    r3,[r5,#4]
+    adds   r3,r3,r2
+    str    r3,[r5,#4]      // outgoing task runtime is at offset 4 in TCB
+    ldr    r3,[r6,#8]
+    adds   r3,r3,#1
+    str    r3,[r6,#8]      // incoming task switches is at offset 8 in TCB
+    cpsie  i
+    str    r6,[r4]         // save new CurrentTask
+    ldr    sp,[r6,#0]      // get sp from new current task
     pop    {r4-r11, pc}
 
+//Pends PendSV, which is taken as soon as the caller runs with interrupts enabled
 Yield:
-	svc #0 					//Raise SVC interrupt
-	bx lr					//return from subroutine
+    ldr    r0,=0xE000ED04  // r0 is address of SCB->ICSR
+    ldr    r1,=0x10000000  // PENDSVSET
+    str    r1,[r0]         // pend the context switch
+    dsb
+    isb
+    bx     lr              //return from subroutine
 
 
 	.end
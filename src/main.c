@@ -2,6 +2,7 @@
 #include "em_chip.h"
 #include "segmentlcd.h"
 #include "myRTOS.h"
+#include "myTrace.h"
 
 //Task Stacks
 //Arrays of 32 bit unsigned integers
@@ -155,9 +156,12 @@ int main(void)
 
   //SYSTEM CLOCK CONFIGURATION
   SystemCoreClock = 14000000; 				  // 14 MHz for this device
-  if (SysTick_Config(SystemCoreClock/1000))  //configured to interrupt every 1ms
+  if (initSystemTick(SystemCoreClock/1000))  //1ms SystemTick, tickless between releases
 	  while (1);
 
+  //TRACE RECORDER INIT
+  vTraceStart(TRACE_MODE_SNAPSHOT); //keep the latest kernel events in TraceBuffer for a debugger dump
+
   //SEMAPHORES INIT
   /* numbers are semaphore indices */
   initSemaphoreBinary(SemaphoreList,6); //initialize the Semaphore list declared above
@@ -169,7 +173,7 @@ int main(void)
   LCDSemaphore = &SemaphoreList[5];
 
   //MAILBOX INIT
-  /* numbers are semaphore indices */
+  /* numbers are legacy semaphore indices, unused since mailboxes became queues */
   initMailbox(&boxC,6); //Initialize Mailboxes Declared above
   initMailbox(&boxD,8);
 
@@ -181,5 +185,9 @@ int main(void)
   CreateTask(4,Task_D_Loop,stack4,100,4);
 
   /* Infinite loop for aperiodic and sporadic tasks */
-  while (1) {idle_count++;}
+  while (1)
+  {
+    idle_count++;
+    if ((idle_count & STACK_SCAN_INTERVAL) == 0) {vTaskStackScan();} //keep stack high-water marks current
+  }
 }
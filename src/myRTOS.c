@@ -20,11 +20,663 @@
 //******************************************************************************************************
 
 //Library Includes
-#include "em_device.h"
-#include "em_chip.h"
-#include "segmentlcd.h"
+#include <string.h>
+#include "port.h"
 #include "myRTOS.h"
+#include "myTrace.h"
 
+//------------------------------------------------------------------------------------------------//
+// -- 								KERNEL PRIVATE DATA										   -- //
+//------------------------------------------------------------------------------------------------//
+#if SCHEDULER == SCHED_EDF
+static TaskControlBlock* ReadyHeap[NUM_TASKS];		 //min-heap of ready tasks keyed on deadline
+static int ReadyHeapSize;							 //number of ready tasks within ReadyHeap
+#else
+static uint32_t ReadyBitmap;						 //bit (31-priority) set while ReadyList[priority] is non-empty
+static TaskControlBlock* ReadyList[MAX_PRIORITIES]; //circular list of ready tasks at each priority
+#endif
+static TaskControlBlock* DelayedList;				 //delta queue of tasks sorted by suspend time
+static uint32_t NextRelease;						 //suspend time of the task at the head of DelayedList
+
+#define EVENT_WAIT_ALL 0x01		//event wait needs every bit set rather than any
+#define EVENT_CLEAR_ON_EXIT 0x02	//event wait clears the bits it waited for once satisfied
+
+#define NOTIFY_NONE 0			//no notification pending
+#define NOTIFY_WAITING 1		//task is blocked waiting for a notification
+#define NOTIFY_PENDING 2		//notification received but not yet consumed
+
+TaskControlBlock TCB[NUM_TASKS]; 		//Array which holds (NUM_TASKS) of Task Control Blocks(TCB)
+volatile TaskControlBlock* CurrentTask; //Points to the current task executing
+uint32_t SystemTick; 					//System Tick incremented as defined by end user
+int idle_count; 						//Count for aperiodic/sporadic tasks
+
+uint32_t RunTimeStamp;				//portCycleCount() at the last context switch, kept by the port
+static uint32_t WindowStart;		//portCycleCount() when the measurement window started
+static xLatencyHistogram LatencyHistogram[LATENCY_KINDS]; //wake-to-dispatch latencies
+static void (*DeadlineMissHook)(int task, uint32_t missed); //called on an overrun, 0 == none
+
+#if TIMER_WHEEL_SLOTS < 32 || TIMER_WHEEL_SLOTS > 1024 || (TIMER_WHEEL_SLOTS & (TIMER_WHEEL_SLOTS-1)) != 0
+#error "TIMER_WHEEL_SLOTS must be a power of 2 from 32 to 1024"
+#endif
+#define TIMER_WHEEL_WORDS (TIMER_WHEEL_SLOTS/32) //TimerBitmap words, one bit of TimerSummary each
+#define TIMER_WHEEL_SHIFT (5 + (TIMER_WHEEL_SLOTS > 32) + (TIMER_WHEEL_SLOTS > 64) + (TIMER_WHEEL_SLOTS > 128) \
+						   + (TIMER_WHEEL_SLOTS > 256) + (TIMER_WHEEL_SLOTS > 512)) //log2 of TIMER_WHEEL_SLOTS
+#define TIMER_UPPER_SLOTS 32 //Slots of every upper level, one TimerUpperBitmap word each
+#define TIMER_UPPER_LEVELS ((32 - TIMER_WHEEL_SHIFT + 4) / 5) //Upper levels, together reaching 2^32 ticks
+#define TIMER_UPPER_SHIFT(level) (TIMER_WHEEL_SHIFT + 5*(level)) //log2 of the ticks one slot of the level spans
+static xTimer* TimerWheel[TIMER_WHEEL_SLOTS]; //running timers due within one rotation, hashed on expiry tick
+static uint32_t TimerBitmap[TIMER_WHEEL_WORDS]; //bit (31-slot%32) of word slot/32 set while TimerWheel[slot] is non-empty
+static uint32_t TimerSummary;		//bit (31-word) set while TimerBitmap[word] is non-zero
+static xTimer* TimerUpper[TIMER_UPPER_LEVELS][TIMER_UPPER_SLOTS]; //running timers a rotation or more ahead, hashed on expiry span
+static uint32_t TimerUpperBitmap[TIMER_UPPER_LEVELS]; //bit (31-slot) set while TimerUpper[level][slot] is non-empty
+static uint32_t TimerUpperFirst[TIMER_UPPER_LEVELS][TIMER_UPPER_SLOTS]; //earliest expiry linked into each upper slot
+static xTimer* TimerExpired;		//expired timers waiting for their callbacks to run
+static uint32_t TimerTick;			//last SystemTick processed by the timer service
+static uint32_t TimerWake;			//SystemTick the timer service sleeps until
+static bool TimerIdle;				//timer service sleeps until notified (no timers running)
+static int TimerServiceTask;		//task identifier of the timer service, 0 == not created
+
+#if TICKLESS
+#define TICKLESS_MIN_CYCLES 64 //shortest SysTick period programmed, closer boundaries are taken early
+#ifndef TICKLESS_RELOAD_CYCLES
+#define TICKLESS_RELOAD_CYCLES 12 //SysTick cycles from tickReprogram's last counter read to the reload
+#endif
+static uint32_t CyclesPerTick;		//SysTick clock cycles within one SystemTick
+static uint32_t TicklessMaxTicks;	//longest period (in ticks) that fits the 24 bit SysTick reload
+static uint32_t TicklessPeriod;	//ticks covered by the running SysTick period, 0 == not started
+static uint32_t TicklessTarget;	//SystemTick value at which the running period ends
+static int32_t TicklessPhase;		//cycles past the SystemTick boundary when the period started
+#endif
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: keyPrecedes
+//*DESCRIPTION: Compares two scheduling keys (priority, period, deadline). Fixed priority compares
+//*priorities. EDF runs the earliest absolute deadline first, periodic jobs ahead of aperiodic
+//*tasks, and falls back to priority between aperiodic tasks or equal deadlines.
+//*INPUTS: Priority, period and deadline of key a followed by those of key b
+//*OUTPUTS: 1 if key a should run before key b, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int keyPrecedes(int32_t priority_a, int32_t period_a, uint32_t deadline_a,
+					   int32_t priority_b, int32_t period_b, uint32_t deadline_b)
+{
+#if SCHEDULER == SCHED_EDF
+	if(period_a != 0 && period_b != 0 && deadline_a != deadline_b)
+	{
+		return (int32_t)(deadline_a - deadline_b) < 0; //earlier deadline, tolerant of tick wrap
+	}
+	if((period_a != 0) != (period_b != 0))
+	{
+		return period_a != 0; //jobs with a deadline run before aperiodic tasks
+	}
+#else
+	(void)period_a; (void)deadline_a; (void)period_b; (void)deadline_b;
+#endif
+	return priority_a < priority_b;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: taskPrecedes
+//*DESCRIPTION: Orders two tasks for the ready queue and for preemption decisions by comparing
+//*their effective (possibly inherited) scheduling keys, see keyPrecedes
+//*INPUTS: Addresses of the two Tasks to compare
+//*OUTPUTS: 1 if task a should run before task b, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int taskPrecedes(TaskControlBlock* a, TaskControlBlock* b)
+{
+	return keyPrecedes(a->priority, a->period, a->deadline, b->priority, b->period, b->deadline);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: preemptsCurrent
+//*DESCRIPTION: Decides whether a task just made ready should preempt the current task. Every task
+//*preempts the idle loop (TCB[0]), which never enters the ready queue.
+//*INPUTS: Address of the ready Task
+//*OUTPUTS: 1 if the task should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int preemptsCurrent(TaskControlBlock* task)
+{
+	TaskControlBlock* current = (TaskControlBlock*)CurrentTask;
+	return current == TCB || taskPrecedes(task, current);
+}
+
+#if SCHEDULER == SCHED_EDF
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: heapSwap
+//*DESCRIPTION: Swaps two ready heap entries and updates the tasks heap positions
+//*INPUTS: Heap positions to swap
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void heapSwap(int i, int j)
+{
+	TaskControlBlock* temp = ReadyHeap[i];
+	ReadyHeap[i] = ReadyHeap[j];
+	ReadyHeap[j] = temp;
+	ReadyHeap[i]->heap_index = i;
+	ReadyHeap[j]->heap_index = j;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: heapSift
+//*DESCRIPTION: Restores the heap order around position i, moving the entry toward the root while
+//*it precedes its parent, otherwise toward the leaves while a child precedes it
+//*INPUTS: Heap position to restore
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void heapSift(int i)
+{
+	while(i > 0 && taskPrecedes(ReadyHeap[i], ReadyHeap[(i-1)/2]))
+	{
+		heapSwap(i, (i-1)/2);
+		i = (i-1)/2;
+	}
+	while(1)
+	{
+		int first = i;
+		int left = 2*i + 1;
+		int right = left + 1;
+		if(left < ReadyHeapSize && taskPrecedes(ReadyHeap[left], ReadyHeap[first]))
+		{
+			first = left;
+		}
+		if(right < ReadyHeapSize && taskPrecedes(ReadyHeap[right], ReadyHeap[first]))
+		{
+			first = right;
+		}
+		if(first == i)
+		{
+			return;
+		}
+		heapSwap(i, first);
+		i = first;
+	}
+}
+#endif
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: readyInsert
+//*DESCRIPTION: Appends a task to the tail of the ready list for its priority and marks that
+//*priority as ready within the ready bitmap (EDF: pushes it onto the ready heap).
+//*Called with interrupts disabled.
+//*INPUTS: Address of the Task to make ready
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void readyInsert(TaskControlBlock* task)
+{
+	task->ready = 1;
+#if SCHEDULER == SCHED_EDF
+	task->heap_index = ReadyHeapSize++;
+	ReadyHeap[task->heap_index] = task;
+	heapSift(task->heap_index);
+#else
+	TaskControlBlock** head = &ReadyList[task->priority];
+	if(*head == 0) //first ready task at this priority
+	{
+		task->next = task;
+		task->prev = task;
+		*head = task;
+		ReadyBitmap |= 0x80000000u >> task->priority;
+	}
+	else //link in before the head, i.e. at the tail of the circular list
+	{
+		task->next = *head;
+		task->prev = (*head)->prev;
+		(*head)->prev->next = task;
+		(*head)->prev = task;
+	}
+#endif
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: readyRemove
+//*DESCRIPTION: Unlinks a task from the ready list for its priority, clearing the priority bit
+//*within the ready bitmap once no ready task remains (EDF: removes it from the ready heap).
+//*Called with interrupts disabled.
+//*INPUTS: Address of the Task to remove
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void readyRemove(TaskControlBlock* task)
+{
+	task->ready = 0;
+#if SCHEDULER == SCHED_EDF
+	int i = task->heap_index;
+	heapSwap(i, --ReadyHeapSize); //move the last entry into the hole and restore heap order
+	if(i < ReadyHeapSize)
+	{
+		heapSift(i);
+	}
+#else
+	TaskControlBlock** head = &ReadyList[task->priority];
+	if(task->next == task) //last ready task at this priority
+	{
+		*head = 0;
+		ReadyBitmap &= ~(0x80000000u >> task->priority);
+	}
+	else
+	{
+		task->prev->next = task->next;
+		task->next->prev = task->prev;
+		if(*head == task)
+		{
+			*head = task->next;
+		}
+	}
+	task->next = 0;
+	task->prev = 0;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: delayInsert
+//*DESCRIPTION: Inserts a task into the delayed list (a delta queue) in suspend time order. The head
+//*is anchored at NextRelease and every later task stores only its delta, the ticks between its
+//*release and the release of the task in front of it. Called with interrupts disabled.
+//*INPUTS: Address of the Task to delay
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void delayInsert(TaskControlBlock* task)
+{
+	uint32_t release = task->suspend;
+	task->delayed = 1;
+	task->prev = 0;
+	task->delta = 0;
+
+	if(DelayedList == 0 || (int32_t)(release - NextRelease) < 0) //new head, tolerant of tick wrap
+	{
+		task->next = DelayedList;
+		if(DelayedList != 0)
+		{
+			DelayedList->delta = NextRelease - release;
+			DelayedList->prev = task;
+		}
+		DelayedList = task;
+		NextRelease = release;
+		return;
+	}
+
+	//Walk past every task released at or before this one, consuming their deltas
+	uint32_t remaining = release - NextRelease;
+	TaskControlBlock* node = DelayedList;
+	while(node->next != 0 && node->next->delta <= remaining)
+	{
+		node = node->next;
+		remaining -= node->delta;
+	}
+	task->delta = remaining;
+	task->prev = node;
+	task->next = node->next;
+	if(node->next != 0)
+	{
+		node->next->delta -= remaining; //the follower is now relative to this task
+		node->next->prev = task;
+	}
+	node->next = task;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: delayRemove
+//*DESCRIPTION: Unlinks a task from the delayed list before its suspend time, handing its delta on
+//*to the task behind it so later releases are unchanged. Called with interrupts disabled.
+//*INPUTS: Address of the delayed Task
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void delayRemove(TaskControlBlock* task)
+{
+	TaskControlBlock* next = task->next;
+	if(task->prev == 0) //head of the queue, the follower becomes the anchored head
+	{
+		DelayedList = next;
+		if(next != 0)
+		{
+			NextRelease += next->delta;
+			next->delta = 0;
+		}
+	}
+	else
+	{
+		task->prev->next = next;
+		if(next != 0)
+		{
+			next->delta += task->delta;
+		}
+	}
+	if(next != 0)
+	{
+		next->prev = task->prev;
+	}
+	task->next = 0;
+	task->prev = 0;
+	task->delayed = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: currentTick
+//*DESCRIPTION: Returns the current SystemTick. In TICKLESS mode SystemTick is only brought up to
+//*date when SysTick is reprogrammed, so the ticks elapsed within the running period are added
+//*from the SysTick counter without disturbing it. Called with interrupts disabled.
+//*INPUTS: N/A
+//*OUTPUTS: Current SystemTick
+//------------------------------------------------------------------------------------------------//
+static uint32_t currentTick(void)
+{
+#if TICKLESS
+	if(TicklessPeriod != 0)
+	{
+		uint32_t count = SysTick->VAL; //read before the pending flag so a wrap in between is seen
+		if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+		{
+			return TicklessTarget; //period ended, interrupt not yet serviced
+		}
+		int32_t cycles = TicklessPhase + (int32_t)(SysTick->LOAD - count);
+		return SystemTick + cycles / (int32_t)CyclesPerTick;
+	}
+#endif
+	return SystemTick;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: waitInsert
+//*DESCRIPTION: Links a blocked task into a wait list behind every task of equal or higher
+//*precedence (see taskPrecedes), so the head is always the next task to wake and tasks of equal
+//*precedence wake in the order they blocked. Called with interrupts disabled.
+//*INPUTS: Address of the Wait List, Address of the blocked Task
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void waitInsert(xWaitList* list, TaskControlBlock* task)
+{
+	TaskControlBlock* prev = 0;
+	TaskControlBlock* next = list->head;
+	while(next != 0 && !taskPrecedes(task, next))
+	{
+		prev = next;
+		next = next->wait_next;
+	}
+	task->waitlist = list;
+	task->wait_prev = prev;
+	task->wait_next = next;
+	if(next != 0)
+	{
+		next->wait_prev = task;
+	}
+	if(prev != 0)
+	{
+		prev->wait_next = task;
+	}
+	else
+	{
+		list->head = task;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: waitRemove
+//*DESCRIPTION: Unlinks a task from the wait list holding it. Called with interrupts disabled.
+//*INPUTS: Address of the waiting Task
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void waitRemove(TaskControlBlock* task)
+{
+	if(task->waitlist == 0)
+	{
+		return; //blocked on a notification, not a kernel object
+	}
+	if(task->wait_prev != 0)
+	{
+		task->wait_prev->wait_next = task->wait_next;
+	}
+	else
+	{
+		task->waitlist->head = task->wait_next;
+	}
+	if(task->wait_next != 0)
+	{
+		task->wait_next->wait_prev = task->wait_prev;
+	}
+	task->waitlist = 0;
+	task->wait_next = 0;
+	task->wait_prev = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: remainingTicks
+//*DESCRIPTION: Ticks left of a timeout that started at a given tick. Called with interrupts
+//*disabled.
+//*INPUTS: SystemTick when the wait started, timeout in ticks (or WAIT_FOREVER)
+//*OUTPUTS: Ticks remaining (0 once expired), WAIT_FOREVER for an unlimited wait
+//------------------------------------------------------------------------------------------------//
+static uint32_t remainingTicks(uint32_t start, uint32_t ticks)
+{
+	if(ticks == WAIT_FOREVER)
+	{
+		return WAIT_FOREVER;
+	}
+	uint32_t elapsed = currentTick() - start;
+	return (elapsed >= ticks) ? 0 : ticks - elapsed;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: blockCurrent
+//*DESCRIPTION: Moves the current task from the ready queue onto a kernel object's wait list. A
+//*timed wait also places the task on the delayed list, so timeouts expire through the same
+//*delta queue as vTaskDelayUntil at no per-tick cost. The caller re-enables interrupts and yields
+//*afterwards, then reads CurrentTask->wake_status. Called with interrupts disabled.
+//*INPUTS: Address of the Wait List (or 0 for a notification wait), Address of the inheritance
+//*Semaphore blocking the task (or 0), timeout in ticks (non-zero, or WAIT_FOREVER)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void blockCurrent(xWaitList* list, xSemaphore* blockedby, uint32_t ticks)
+{
+	TaskControlBlock* task = (TaskControlBlock*)CurrentTask;
+	readyRemove(task);
+	task->blocked = 1;
+	task->blockedby = blockedby; //Set the semaphore identifier
+	task->wake_status = RTOS_TIMEOUT;
+	if(list != 0)
+	{
+		waitInsert(list, task);
+	}
+	if(ticks != WAIT_FOREVER)
+	{
+		task->suspend = currentTick() + ticks;
+		delayInsert(task);
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: latencyStart
+//*DESCRIPTION: Timestamps a task made ready, so the latency until it is switched in is recorded
+//*into the kind's histogram. Called with interrupts disabled.
+//*INPUTS: Address of the Task, kind (LATENCY_ histogram, LATENCY_NONE == not recorded)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void latencyStart(TaskControlBlock* task, int32_t kind)
+{
+#if LATENCY_HISTOGRAMS
+	task->latency_stamp = portCycleCount();
+	task->latency_kind = kind;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: latencyDispatch
+//*DESCRIPTION: Records the latency of a task being switched in, if it was timed by latencyStart.
+//*Constant time: the bucket is the bit length of the latency. Called with interrupts disabled.
+//*INPUTS: Address of the Task being switched in
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void latencyDispatch(TaskControlBlock* task)
+{
+#if LATENCY_HISTOGRAMS
+	if(task->latency_kind == LATENCY_NONE)
+	{
+		return;
+	}
+	xLatencyHistogram* histogram = &LatencyHistogram[task->latency_kind];
+	uint32_t latency = portCycleCount() - task->latency_stamp;
+	uint32_t bucket = 32 - __CLZ(latency);
+	histogram->bucket[(bucket < LATENCY_BUCKETS) ? bucket : LATENCY_BUCKETS-1]++;
+	histogram->samples++;
+	if(latency > histogram->max)
+	{
+		histogram->max = latency;
+	}
+	task->latency_kind = LATENCY_NONE;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: wakeTask
+//*DESCRIPTION: Moves a blocked task from its wait list back onto the ready queue, cancelling any
+//*timeout. Called with interrupts disabled.
+//*INPUTS: Address of the blocked Task
+//*OUTPUTS: 1 if the woken task should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int wakeTask(TaskControlBlock* task)
+{
+	waitRemove(task);
+	if(task->delayed)
+	{
+		delayRemove(task); //cancel the timeout
+	}
+	task->blocked = 0;
+	task->blockedby = 0;
+	task->wake_status = RTOS_OK;
+	readyInsert(task);
+	latencyStart(task, (__get_IPSR() != 0) ? LATENCY_INTERRUPT : LATENCY_NONE);
+	return preemptsCurrent(task);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: pendSwitch
+//*DESCRIPTION: Requests a context switch from an interrupt handler. PendSV runs at the lowest
+//*priority, so the switch happens once every active interrupt has returned.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void pendSwitch(void)
+{
+	portPendSwitch();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: taskBoosted
+//*DESCRIPTION: Tells whether a task runs on a scheduling key inherited from a waiter rather than
+//*its own (base) key. Called with interrupts disabled.
+//*INPUTS: Address of the Task
+//*OUTPUTS: 1 if the task is boosted, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int taskBoosted(TaskControlBlock* task)
+{
+	return task->priority != task->base_priority || task->period != task->base_period
+		   || task->deadline != task->base_deadline;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: refreshPrecedence
+//*DESCRIPTION: Priority inheritance. Recomputes a task's effective scheduling key as the higher of
+//*its own (base) key and the key of the highest waiter on every semaphore it holds, requeueing
+//*the task if it is ready. When the task is itself blocked on an inheritance semaphore the change
+//*is passed on to that semaphore's owner, giving chained inheritance. Also accumulates the time
+//*each task spends boosted. Called with interrupts disabled.
+//*INPUTS: Address of the Task to update
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void refreshPrecedence(TaskControlBlock* task)
+{
+	while(task != 0)
+	{
+		int32_t priority = task->base_priority;
+		int32_t period = task->base_period;
+		uint32_t deadline = task->base_deadline;
+		for(xSemaphore* held = task->held; held != 0; held = held->held_next)
+		{
+			TaskControlBlock* waiter = held->waiters.head;
+			if(waiter != 0 && keyPrecedes(waiter->priority, waiter->period, waiter->deadline,
+										  priority, period, deadline))
+			{
+				priority = waiter->priority; //inherit the waiter's key
+				period = waiter->period;
+				deadline = waiter->deadline;
+			}
+		}
+		if(priority == task->priority && period == task->period && deadline == task->deadline)
+		{
+			return; //unchanged, so nothing further along the chain changes either
+		}
+
+		int was_boosted = taskBoosted(task);
+		int is_boosted = priority != task->base_priority || period != task->base_period
+						 || deadline != task->base_deadline;
+		if(!was_boosted && is_boosted)
+		{
+			task->boost_start = currentTick();
+		}
+		else if(was_boosted && !is_boosted)
+		{
+			task->boost_ticks += currentTick() - task->boost_start;
+		}
+
+		int ready = task->ready;
+		xWaitList* waitlist = task->waitlist;
+		if(ready)
+		{
+			readyRemove(task); //leave the ready queue while the key changes
+		}
+		if(waitlist != 0)
+		{
+			waitRemove(task); //and keep any wait list in precedence order
+		}
+		task->priority = priority;
+		task->period = period;
+		task->deadline = deadline;
+		if(ready)
+		{
+			readyInsert(task);
+		}
+		if(waitlist != 0)
+		{
+			waitInsert(waitlist, task);
+		}
+
+		//A blocked task passes its new key on to the owner of the semaphore blocking it. Tasks
+		//blocked on queues, mailboxes, counting semaphores, notifications or event groups have no
+		//blockedby semaphore and no owner to pass it on to.
+		task = (task->blocked == 1 && task->blockedby != 0 && task->blockedby->inherit)
+			   ? task->blockedby->owner : 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: heldRemove
+//*DESCRIPTION: Removes an inheritance semaphore from its owner's list of held semaphores.
+//*Called with interrupts disabled.
+//*INPUTS: Address of Semaphore
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void heldRemove(xSemaphore* Semaphore)
+{
+	xSemaphore** link = &Semaphore->owner->held;
+	while(*link != Semaphore)
+	{
+		link = &(*link)->held_next;
+	}
+	*link = Semaphore->held_next;
+	Semaphore->held_next = 0;
+	Semaphore->owner = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: heldInsert
+//*DESCRIPTION: Records a task as the owner of an inheritance semaphore. Called with interrupts
+//*disabled.
+//*INPUTS: Address of Semaphore, Address of the owning Task
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void heldInsert(xSemaphore* Semaphore, TaskControlBlock* owner)
+{
+	Semaphore->owner = owner;
+	Semaphore->held_next = owner->held;
+	owner->held = Semaphore;
+}
 
 //------------------------------------------------------------------------------------------------//
 //*FUNCTION: CreateTask
@@ -36,178 +688,1997 @@
 //------------------------------------------------------------------------------------------------//
 void CreateTask(int task, void (*funct)(), void *stack, uint32_t stack_words, int32_t priority)
 {
-	uint32_t *ptr = (uint32_t *)stack + (stack_words-1); // a pointer to the last byte of stack
-	*ptr-- = 0x01000000; 								 // xPSR, Thumb state only (program status register), decrement the stack pointer
-	*ptr-- = (uint32_t)funct; 							 //decrement it again and have it point to our function
-	for (int i=0; i<6; ++i)	*ptr-- = 0; 				 // lr, r12, r3, r2, r1, r0 , place 0's in the stack for the next 6 positions
-	*ptr = -7; 											 // exception link register
-	for (int i=0; i<8; ++i)	*--ptr = 0; 				 // r11, r10, r9, r8, r7, r6, r5, r4 // place some more zeros
-
+#if STACK_PAINT
+	for(uint32_t i = 0; i < stack_words; i++)
+	{
+		((uint32_t *)stack)[i] = STACK_PAINT_PATTERN; //words never overwritten were never used
+	}
+#endif
 	//Define Task Specific Paramters
-	TCB[task].stack_pointer = ptr;	//
+	TCB[task].stack_pointer = portInitStack(task, stack, stack_words, funct); //initial frame of the port
 	TCB[task].suspend = 0;			//Time scheduler is to suspend before scheduling the task, 0 = task is initially available
 	TCB[task].priority = priority;  //Defined Task Priority, lower = higher priority
 	TCB[task].blocked = 0; 			//Blocking Identifier, 0 = not initially blocked
-	TCB[task].blockedby = 0; 		//Index of blocking task, 0 = nobody is blocking
+	TCB[task].blockedby = 0; 		//Blocking semaphore, 0 = nobody is blocking
+	TCB[task].delayed = 0;			//Not waiting for a release or timeout
+	TCB[task].wake_status = RTOS_OK;
 	TCB[task].task = task;			//Task Identifier
+	TCB[task].period = 0;			//Aperiodic until the task calls vTaskDelayUntil
+	TCB[task].deadline = 0;			//No deadline for an aperiodic task
+	TCB[task].base_priority = priority; //Unboosted scheduling key
+	TCB[task].base_period = 0;
+	TCB[task].base_deadline = 0;
+	TCB[task].held = 0;				//Holds no semaphores
+	TCB[task].waitlist = 0;			//Not waiting on any kernel object
+	TCB[task].wait_next = 0;
+	TCB[task].wait_prev = 0;
+	TCB[task].boost_ticks = 0;
+	TCB[task].notify_value = 0;		//No notification received
+	TCB[task].notify_state = NOTIFY_NONE;
+	TCB[task].stack_base = (uint32_t *)stack; //Stack grows down toward the base
+	TCB[task].stack_words = stack_words;
+	TCB[task].stack_free = stack_words - 17; //Below the initial frame until measured
+	TCB[task].runtime = 0;			//Has not run yet
+	TCB[task].switches = 0;
+	TCB[task].window_runtime = 0;
+	TCB[task].window_switches = 0;
+	TCB[task].latency_kind = LATENCY_NONE; //No dispatch being timed
+	TCB[task].deadline_policy = DEADLINE_CATCH_UP; //Missed jobs run late rather than not at all
+	TCB[task].deadline_misses = 0;
+	TCB[task].skipped_releases = 0;
+
+	__disable_irq();
+	readyInsert(&TCB[task]);		//Task is initially available, so place it in the ready queue
+	int preempt = preemptsCurrent(&TCB[task]);
+	__enable_irq();
+	if(preempt)
+	{
+		Yield(); //SysTick only switches when a delayed task is released, so switch to it here
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initSemaphoreBinary
+//*DESCRIPTION: initializes a array of binary semaphore to untaken and assigns an index to each
+//*INPUTS: Beginning Address of a Semaphore Array (SemaphoreList) and the initial size of the array
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initSemaphoreBinary(xSemaphore* SemaphoreList, int initialSize)
+{
+	//Initialize all values of given semaphore
+	for(int i = 0; i < initialSize; i++)
+	{
+		SemaphoreList[i].Semaphore = false; //untaken initially
+		SemaphoreList[i].index = i;
+		SemaphoreList[i].waiters.head = 0;	//nobody blocked
+		SemaphoreList[i].inherit = true;	//owners inherit the priority of blocked tasks
+		SemaphoreList[i].owner = 0;
+		SemaphoreList[i].held_next = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initSemaphoreSignal
+//*DESCRIPTION: initializes a array of signalling semaphores, e.g. given by an ISR and taken by the
+//*task it wakes. They start taken (nothing signalled) and have no owner, so no task inherits the
+//*priority of the tasks waiting on them.
+//*INPUTS: Beginning Address of a Semaphore Array (SemaphoreList) and the initial size of the array
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initSemaphoreSignal(xSemaphore* SemaphoreList, int initialSize)
+{
+	initSemaphoreBinary(SemaphoreList, initialSize);
+	for(int i = 0; i < initialSize; i++)
+	{
+		SemaphoreList[i].Semaphore = true;	//nothing signalled yet
+		SemaphoreList[i].inherit = false;	//takers signal, they do not own the semaphore
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreTake
+//*DESCRIPTION: Take semaphore if available, otherwise block and identify the semaphore that
+//*blocks the current task. The owner of an inheritance semaphore is boosted to the precedence
+//*of the blocked task.
+//*INPUTS: Address of Semaphore to Take
+//*OUTPUTS: Task blocked or Semaphore Taken
+//------------------------------------------------------------------------------------------------//
+void xSemaphoreTake(xSemaphore* Semaphore)
+{
+	xSemaphoreTakeTimeout(Semaphore, WAIT_FOREVER);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreTakeTimeout
+//*DESCRIPTION: xSemaphoreTake that gives up once ticks SystemTicks pass without the semaphore
+//*being handed over. A timed out task leaves the wait list and no longer boosts the owner.
+//*INPUTS: Address of Semaphore to Take, timeout in ticks (0 == do not block, WAIT_FOREVER)
+//*OUTPUTS: RTOS_OK once the Semaphore is Taken, RTOS_TIMEOUT if the timeout expired
+//------------------------------------------------------------------------------------------------//
+int xSemaphoreTakeTimeout(xSemaphore* Semaphore, uint32_t ticks)
+{
+	__disable_irq(); //disable interrupts
+	if(Semaphore->Semaphore == false)
+	{
+		Semaphore->Semaphore = true;//Semaphore is free to take, so take it
+		//Set the field to say who took the semaphore (so that we can tell who is blocking)
+		if(Semaphore->inherit)
+		{
+			heldInsert(Semaphore, (TaskControlBlock*)CurrentTask);
+		}
+		TRACE_EVENT(TRACE_EVT_SEM_TAKE, TRACE_OBJECT(Semaphore));
+		__enable_irq();
+		return RTOS_OK;
+	}
+	if(ticks == 0)
+	{
+		__enable_irq();
+		return RTOS_TIMEOUT; //caller would rather not wait
+	}
+
+	//if we cannot take the semaphore, then block the task trying to take it
+	//and identify the current task its blocked by
+	TRACE_EVENT(TRACE_EVT_SEM_BLOCK, TRACE_OBJECT(Semaphore));
+	blockCurrent(&Semaphore->waiters, Semaphore, ticks);
+	if(Semaphore->inherit && Semaphore->owner != 0)
+	{
+		refreshPrecedence(Semaphore->owner); //boost the owner (and whoever blocks it)
+	}
+	__enable_irq();
+	Yield();
+	if(CurrentTask->wake_status == RTOS_OK)
+	{
+		TRACE_EVENT(TRACE_EVT_SEM_TAKE, TRACE_OBJECT(Semaphore));
+	}
+	return CurrentTask->wake_status; //xSemaphoreGive handed the semaphore over, or timed out
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: semaphoreGive
+//*DESCRIPTION: Releases the semaphore, an algorithm designed within decides if the semaphore is
+//*free or taken by another task that was previously blocked by it. Called with interrupts
+//*disabled.
+//*INPUTS: Address of Semaphore to Give
+//*OUTPUTS: 1 if the task handed the semaphore should preempt the current task, 0 otherwise.
+//*The previous owner of an inheritance semaphore drops back to its own priority, or to the
+//*highest waiter on any other semaphore it still holds.
+//------------------------------------------------------------------------------------------------//
+static int semaphoreGive(xSemaphore* Semaphore)
+{
+//ALGORITHM PSUEDO CODE
+//Check the head of the semaphores wait list (highest priority waiter first):
+	//Is there somebody else waiting for the semaphore(i.e., blocked)? Thats not CurrentTask
+		//No - set semaphore to false (releasing the semaphore)
+		//Yes - unblock highest priority task waiting for the semaphore, leave semaphore to true
+	//Does the task unblockeds priority greater than the current tasks priority?
+		//Yes - Yield (i.e., invoke the scheduler to schedule that task)
+		//No - Return (your higher priority so continue running)
+
+	TRACE_EVENT(TRACE_EVT_SEM_GIVE, TRACE_OBJECT(Semaphore));
+	TaskControlBlock* waiter = Semaphore->waiters.head; //highest priority task blocked by semaphore (if it exists)
+	TaskControlBlock* owner = Semaphore->owner;
+	if(owner != 0)
+	{
+		heldRemove(Semaphore); //the owner no longer inherits through this semaphore
+	}
+
+	if(waiter == 0) //there were no blocked tasks
+	{
+		Semaphore->Semaphore=false;// give the semaphore
+	}
+	else
+	{
+		wakeTask(waiter); //unblock the highest priority task waiting for the semaphore
+						  //and hand it the semaphore, which stays taken
+		if(waiter->latency_kind == LATENCY_NONE)
+		{
+			waiter->latency_kind = LATENCY_SEMAPHORE; //handed over by a task, not an ISR
+		}
+		if(Semaphore->inherit)
+		{
+			heldInsert(Semaphore, waiter);
+			refreshPrecedence(waiter); //inherit from the tasks still blocked by the semaphore
+		}
+	}
+	if(owner != 0)
+	{
+		refreshPrecedence(owner); //restore the previous owner's priority
+	}
+
+	//Check if the current task running or the newly unblocked task has higher priority
+	return waiter != 0 && preemptsCurrent(waiter);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreGive
+//*DESCRIPTION: Releases the semaphore (see semaphoreGive), invoking the scheduler if the task
+//*handed the semaphore has higher priority
+//*INPUTS: Address of Semaphore to Give
+//*OUTPUTS: Semaphore Released or Taken by highest priority task blocked by the Semaphore
+//------------------------------------------------------------------------------------------------//
+void xSemaphoreGive(xSemaphore* Semaphore)
+{
+	__disable_irq(); //disable interrupts
+	int preempt = semaphoreGive(Semaphore);
+	__enable_irq(); //enable interrupts
+	if(preempt)
+	{
+		Yield(); //invoke scheduler and run the newly unblocked task
+	}
+	//Otherwise continue running the current task since our priority is higher
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreGiveFromISR
+//*DESCRIPTION: xSemaphoreGive for interrupt handlers, pending the context switch (see pendSwitch)
+//*rather than yielding. Intended for signalling semaphores (initSemaphoreSignal), not inheritance
+//*semaphores a task took.
+//*INPUTS: Address of Semaphore to Give
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void xSemaphoreGiveFromISR(xSemaphore* Semaphore)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(semaphoreGive(Semaphore))
+	{
+		pendSwitch();
+	}
+	__set_PRIMASK(primask);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initSemaphoreCounting
+//*DESCRIPTION: initializes a counting semaphore with a number of available units
+//*INPUTS: Address of the Counting Semaphore, units initially available, most units it can hold
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initSemaphoreCounting(xSemaphoreCounting* Semaphore, uint32_t initial, uint32_t max_count)
+{
+	Semaphore->count = initial;
+	Semaphore->max_count = max_count;
+	Semaphore->waiters.head = 0; //nobody blocked
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreTakeCounting
+//*DESCRIPTION: Takes one unit from a counting semaphore, blocking until one is given
+//*INPUTS: Address of the Counting Semaphore
+//*OUTPUTS: Unit taken, or task blocked until one is given
+//------------------------------------------------------------------------------------------------//
+void xSemaphoreTakeCounting(xSemaphoreCounting* Semaphore)
+{
+	xSemaphoreTakeCountingTimeout(Semaphore, WAIT_FOREVER);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreTakeCountingTimeout
+//*DESCRIPTION: Takes one unit from a counting semaphore. While units remain the count is
+//*decremented with an exclusive load/store (LDREX/STREX) retry loop, without disabling
+//*interrupts or entering the scheduler. Only when the count is zero does the task block, in
+//*which case xSemaphoreGiveCounting hands the next unit directly to the highest waiter.
+//*INPUTS: Address of the Counting Semaphore, timeout in ticks (0 == do not block, WAIT_FOREVER)
+//*OUTPUTS: RTOS_OK once a unit is taken, RTOS_TIMEOUT if the timeout expired
+//------------------------------------------------------------------------------------------------//
+int xSemaphoreTakeCountingTimeout(xSemaphoreCounting* Semaphore, uint32_t ticks)
+{
+	while(1)
+	{
+		//Fast path: any context switch between LDREX and STREX clears the exclusive monitor,
+		//so the store fails and the count is re-read
+		uint32_t count = __LDREXW(&Semaphore->count);
+		if(count != 0)
+		{
+			if(__STREXW(count-1, &Semaphore->count) == 0)
+			{
+				TRACE_EVENT(TRACE_EVT_SEM_TAKE, TRACE_OBJECT(Semaphore));
+				return RTOS_OK; //unit taken
+			}
+			continue;
+		}
+		__CLREX();
+
+		//Slow path: recheck with interrupts disabled, a unit may have been given meanwhile
+		__disable_irq();
+		if(Semaphore->count != 0)
+		{
+			__enable_irq();
+			continue;
+		}
+		if(ticks == 0)
+		{
+			__enable_irq();
+			return RTOS_TIMEOUT; //caller would rather not wait
+		}
+		TRACE_EVENT(TRACE_EVT_SEM_BLOCK, TRACE_OBJECT(Semaphore));
+		blockCurrent(&Semaphore->waiters, 0, ticks); //no owner to inherit through
+		__enable_irq();
+		Yield(); //resumes once a unit has been handed over or the timeout expired
+		if(CurrentTask->wake_status == RTOS_OK)
+		{
+			TRACE_EVENT(TRACE_EVT_SEM_TAKE, TRACE_OBJECT(Semaphore));
+		}
+		return CurrentTask->wake_status;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: countingGive
+//*DESCRIPTION: Gives one unit back to a counting semaphore. With nobody blocked the count is
+//*incremented with an exclusive load/store retry loop. Otherwise the unit goes straight to the
+//*highest precedence waiter. Restores the caller's interrupt mask, so it serves tasks and ISRs.
+//*INPUTS: Address of the Counting Semaphore, Address to return whether the woken waiter should
+//*preempt the current task
+//*OUTPUTS: RTOS_OK, or RTOS_FULL if the semaphore already holds max_count units
+//------------------------------------------------------------------------------------------------//
+static int countingGive(xSemaphoreCounting* Semaphore, int* preempt)
+{
+	*preempt = 0;
+	while(1)
+	{
+		//Fast path: waiters only join with a zero count from another task, i.e. after a context
+		//switch, which makes the STREX below fail and the waiter check run again
+		uint32_t count = __LDREXW(&Semaphore->count);
+		if(Semaphore->waiters.head != 0)
+		{
+			__CLREX();
+			break;
+		}
+		if(count >= Semaphore->max_count)
+		{
+			__CLREX();
+			return RTOS_FULL;
+		}
+		if(__STREXW(count+1, &Semaphore->count) == 0)
+		{
+			return RTOS_OK;
+		}
+	}
+
+	//Slow path: hand the unit to the highest precedence waiter
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	int status = RTOS_OK;
+	TaskControlBlock* waiter = Semaphore->waiters.head;
+	if(waiter != 0)
+	{
+		*preempt = wakeTask(waiter);
+		if(waiter->latency_kind == LATENCY_NONE)
+		{
+			waiter->latency_kind = LATENCY_SEMAPHORE; //handed over by a task, not an ISR
+		}
+	}
+	else if(Semaphore->count < Semaphore->max_count) //the waiter left meanwhile, so keep the unit
+	{
+		Semaphore->count++;
+	}
+	else
+	{
+		status = RTOS_FULL;
+	}
+	__set_PRIMASK(primask);
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreGiveCounting
+//*DESCRIPTION: Gives one unit back to a counting semaphore (see countingGive), yielding if the
+//*waiter it went to should preempt the current task
+//*INPUTS: Address of the Counting Semaphore
+//*OUTPUTS: RTOS_OK, or RTOS_FULL if the semaphore already holds max_count units
+//------------------------------------------------------------------------------------------------//
+int xSemaphoreGiveCounting(xSemaphoreCounting* Semaphore)
+{
+	int preempt;
+	int status = countingGive(Semaphore, &preempt);
+	if(status == RTOS_OK)
+	{
+		TRACE_EVENT(TRACE_EVT_SEM_GIVE, TRACE_OBJECT(Semaphore));
+	}
+	if(preempt)
+	{
+		Yield(); //invoke scheduler
+	}
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xSemaphoreGiveCountingFromISR
+//*DESCRIPTION: xSemaphoreGiveCounting for interrupt handlers, pending the context switch (see
+//*pendSwitch) rather than yielding
+//*INPUTS: Address of the Counting Semaphore
+//*OUTPUTS: RTOS_OK, or RTOS_FULL if the semaphore already holds max_count units
+//------------------------------------------------------------------------------------------------//
+int xSemaphoreGiveCountingFromISR(xSemaphoreCounting* Semaphore)
+{
+	int preempt;
+	int status = countingGive(Semaphore, &preempt);
+	if(status == RTOS_OK)
+	{
+		TRACE_EVENT(TRACE_EVT_SEM_GIVE, TRACE_OBJECT(Semaphore));
+	}
+	if(preempt)
+	{
+		pendSwitch();
+	}
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTaskDelayUntil
+//*DESCRIPTION: delays scheduler from scheduling the current task until a user defined release
+//*time relative to the system tick. updates the next release time based off of the period.
+//*The released job's absolute deadline is its release plus the period (used by EDF).
+//*A job that completes once the next release (its deadline) has already been reached overran:
+//*it is counted as a deadline miss, the task's DEADLINE_ policy decides which release runs next
+//*and the deadline miss hook, if set, is called from the task before it runs on.
+//*INPUTS: Pointer to the tasks release_time and period as defined by user.
+//*OUTPUTS:
+//------------------------------------------------------------------------------------------------//
+void vTaskDelayUntil(int* release_time, int period)
+{
+	TaskControlBlock* task = (TaskControlBlock*)CurrentTask;
+	uint32_t missed = 0; //releases already due when the job completed
+	__disable_irq();
+	uint32_t now = currentTick(); //SystemTick lags behind within a TICKLESS period
+	uint32_t late = now - (uint32_t)*release_time;
+	if(task->base_period != 0 && (int32_t)late >= 0) //a previous call released this job
+	{
+		missed = (period > 0) ? late / (uint32_t)period + 1 : 1;
+		task->deadline_misses++;
+		if(task->deadline_policy == DEADLINE_SKIP)
+		{
+			*release_time += (int)(missed - 1) * period; //latest release, its deadline is still ahead
+			task->skipped_releases += missed - 1;
+		}
+	}
+	readyRemove(task); //leave the ready queue while the deadline (heap key) changes
+	task->suspend = *release_time; //Current Task won't be released until suspend > sysTick
+	*release_time += period; //Update the tasks next release time based off of tasks period
+	int boosted = taskBoosted(task); //against the key of the job that just completed
+	task->base_period = period;
+	task->base_deadline = *release_time; //next job is due by the following release
+	if(!boosted)
+	{
+		task->period = period; //an unboosted task runs on its base key, no boost starts or ends
+		task->deadline = *release_time;
+	}
+	else if(!taskBoosted(task))
+	{
+		task->boost_ticks += currentTick() - task->boost_start; //new key reached the inherited one
+	}
+	refreshPrecedence(task); //apply the new key, unless a blocked task still boosts it
+	if((int32_t)((uint32_t)task->suspend - now) > 0) //release time still ahead, tolerant of tick wrap
+	{
+		delayInsert(task);
+	}
+	else
+	{
+		readyInsert(task); //already released, the job runs immediately
+	}
+	__enable_irq();
+	if(missed != 0 && DeadlineMissHook != 0)
+	{
+		DeadlineMissHook(task->task, missed);
+	}
+	Yield(); //invoke the scheduler
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTaskSetDeadlinePolicy
+//*DESCRIPTION: Selects what vTaskDelayUntil does once a job of the task overran its deadline.
+//*DEADLINE_CATCH_UP (default) releases every missed job immediately, back to back, keeping the
+//*job count but running late until the task catches up. DEADLINE_SKIP drops the releases whose
+//*deadline has already passed and runs the latest one, keeping the task on time (e.g. display
+//*refreshes, where only the newest frame matters).
+//*INPUTS: task (task identifier), policy (DEADLINE_CATCH_UP or DEADLINE_SKIP)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTaskSetDeadlinePolicy(int task, int32_t policy)
+{
+	TCB[task].deadline_policy = policy;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: uxTaskGetDeadlineMisses
+//*DESCRIPTION: Reports how often a periodic task overran since it was created
+//*INPUTS: task (task identifier), Address to store the releases dropped by DEADLINE_SKIP (or 0)
+//*OUTPUTS: Jobs of the task completed after their deadline
+//------------------------------------------------------------------------------------------------//
+uint32_t uxTaskGetDeadlineMisses(int task, uint32_t* skipped)
+{
+	__disable_irq();
+	uint32_t misses = TCB[task].deadline_misses;
+	if(skipped != 0)
+	{
+		*skipped = TCB[task].skipped_releases;
+	}
+	__enable_irq();
+	return misses;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vSetDeadlineMissHook
+//*DESCRIPTION: Installs a hook called by vTaskDelayUntil, in the context of the overrunning task
+//*with interrupts enabled, each time a job completes after its deadline. missed counts the
+//*releases already due (1 == only the next job is late).
+//*INPUTS: hook function, 0 removes the hook
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vSetDeadlineMissHook(void (*hook)(int task, uint32_t missed))
+{
+	DeadlineMissHook = hook;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTaskYield
+//*DESCRIPTION: Cooperative scheduling. Moves the current task behind every other ready task of
+//*its priority and lets the next of them run (EDF: lets a task of equal precedence run, if the
+//*ready heap holds one ahead of the current task)
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTaskYield(void)
+{
+	TaskControlBlock* task = (TaskControlBlock*)CurrentTask;
+	__disable_irq();
+	if(task->ready)
+	{
+#if SCHEDULER == SCHED_EDF
+		readyRemove(task);
+		readyInsert(task);
+#else
+		if(ReadyList[task->priority] == task)
+		{
+			ReadyList[task->priority] = task->next; //the circular list's tail is now the task
+		}
+#endif
+	}
+	__enable_irq();
+	Yield();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initQueue
+//*DESCRIPTION: initializes an empty message queue over caller provided storage
+//*INPUTS: Address of the Queue, storage of depth*item_size bytes, bytes per item, items it holds
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initQueue(xQueue* queue, void* storage, uint32_t item_size, uint32_t depth)
+{
+	queue->storage = (uint8_t*)storage;
+	queue->item_size = item_size;
+	queue->depth = depth;
+	queue->head = 0;
+	queue->tail = 0;
+	queue->count = 0; //empty initially
+	queue->senders.head = 0;
+	queue->receivers.head = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: queuePut
+//*DESCRIPTION: Copies an item to the back of a queue with space and wakes the highest precedence
+//*task blocked receiving. Called with interrupts disabled.
+//*INPUTS: Address of the (not full) Queue, Address of the item to copy in
+//*OUTPUTS: 1 if the woken receiver should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int queuePut(xQueue* queue, const void* item)
+{
+	memcpy(queue->storage + queue->tail*queue->item_size, item, queue->item_size);
+	queue->tail = (queue->tail + 1 == queue->depth) ? 0 : queue->tail + 1;
+	queue->count++;
+	return queue->receivers.head != 0 && wakeTask(queue->receivers.head);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: queueGet
+//*DESCRIPTION: Copies the oldest item out of a non-empty queue and wakes the highest precedence
+//*task blocked sending. Called with interrupts disabled.
+//*INPUTS: Address of the (not empty) Queue, Address to copy the item out to
+//*OUTPUTS: 1 if the woken sender should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int queueGet(xQueue* queue, void* item)
+{
+	memcpy(item, queue->storage + queue->head*queue->item_size, queue->item_size);
+	queue->head = (queue->head + 1 == queue->depth) ? 0 : queue->head + 1;
+	queue->count--;
+	return queue->senders.head != 0 && wakeTask(queue->senders.head);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueSend
+//*DESCRIPTION: Copies an item to the back of the queue, blocking only while the queue is full
+//*INPUTS: Address of the Queue, Address of the item to copy in
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void xQueueSend(xQueue* queue, const void* item)
+{
+	xQueueSendTimeout(queue, item, WAIT_FOREVER);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: queueSend
+//*DESCRIPTION: Body of xQueueSendTimeout and writeToBoxTimeout. A mailbox write is recorded
+//*before a woken receiver can run and record its read, so a trace keeps every message's write
+//*ahead of its read.
+//*INPUTS: Address of the Queue, Address of the item to copy in, timeout in ticks, Address of the
+//*Mailbox built on the queue (0 == plain queue, nothing recorded)
+//*OUTPUTS: RTOS_OK once the item is queued, RTOS_TIMEOUT if the queue stayed full
+//------------------------------------------------------------------------------------------------//
+static int queueSend(xQueue* queue, const void* item, uint32_t ticks, xMailbox* box)
+{
+	__disable_irq();
+	uint32_t start = currentTick();
+	while(queue->count == queue->depth) //full, wait for a receiver to make space
+	{
+		uint32_t remaining = remainingTicks(start, ticks);
+		if(remaining == 0)
+		{
+			__enable_irq();
+			return RTOS_TIMEOUT;
+		}
+		blockCurrent(&queue->senders, 0, remaining);
+		__enable_irq();
+		Yield();
+		__disable_irq(); //another sender may have taken the space first, so check again
+	}
+
+	int preempt = queuePut(queue, item);
+	if(box != 0)
+	{
+		TRACE_EVENT(TRACE_EVT_MBOX_WRITE, TRACE_OBJECT(box));
+	}
+	__enable_irq();
+	if(preempt)
+	{
+		Yield(); //the receiver preempts the current task
+	}
+	return RTOS_OK;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueSendTimeout
+//*DESCRIPTION: Copies an item to the back of the queue, blocking only while the queue is full.
+//*Wakes the highest precedence task blocked receiving from an empty queue.
+//*INPUTS: Address of the Queue, Address of the item to copy in, timeout in ticks
+//*(0 == do not block, WAIT_FOREVER)
+//*OUTPUTS: RTOS_OK once the item is queued, RTOS_TIMEOUT if the queue stayed full
+//------------------------------------------------------------------------------------------------//
+int xQueueSendTimeout(xQueue* queue, const void* item, uint32_t ticks)
+{
+	return queueSend(queue, item, ticks, 0);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueReceive
+//*DESCRIPTION: Copies the oldest item out of the queue, blocking only while the queue is empty
+//*INPUTS: Address of the Queue, Address to copy the item out to
+//*OUTPUTS: returns (through a pointer) the oldest item within the queue
+//------------------------------------------------------------------------------------------------//
+void xQueueReceive(xQueue* queue, void* item)
+{
+	xQueueReceiveTimeout(queue, item, WAIT_FOREVER);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: queueReceive
+//*DESCRIPTION: Body of xQueueReceiveTimeout and readFromBoxTimeout. A mailbox read is recorded
+//*before a woken sender can run and record its next write.
+//*INPUTS: Address of the Queue, Address to copy the item out to, timeout in ticks, Address of the
+//*Mailbox built on the queue (0 == plain queue, nothing recorded)
+//*OUTPUTS: RTOS_OK with the oldest item returned through the pointer, RTOS_TIMEOUT if the queue
+//*stayed empty
+//------------------------------------------------------------------------------------------------//
+static int queueReceive(xQueue* queue, void* item, uint32_t ticks, xMailbox* box)
+{
+	__disable_irq();
+	uint32_t start = currentTick();
+	while(queue->count == 0) //empty, wait for a sender
+	{
+		uint32_t remaining = remainingTicks(start, ticks);
+		if(remaining == 0)
+		{
+			__enable_irq();
+			return RTOS_TIMEOUT;
+		}
+		blockCurrent(&queue->receivers, 0, remaining);
+		__enable_irq();
+		Yield();
+		__disable_irq(); //another receiver may have taken the item first, so check again
+	}
+
+	int preempt = queueGet(queue, item);
+	if(box != 0)
+	{
+		TRACE_EVENT(TRACE_EVT_MBOX_READ, TRACE_OBJECT(box));
+	}
+	__enable_irq();
+	if(preempt)
+	{
+		Yield(); //the sender preempts the current task
+	}
+	return RTOS_OK;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueReceiveTimeout
+//*DESCRIPTION: Copies the oldest item out of the queue, blocking only while the queue is empty.
+//*Wakes the highest precedence task blocked sending to a full queue.
+//*INPUTS: Address of the Queue, Address to copy the item out to, timeout in ticks
+//*(0 == do not block, WAIT_FOREVER)
+//*OUTPUTS: RTOS_OK with the oldest item returned through the pointer, RTOS_TIMEOUT if the queue
+//*stayed empty
+//------------------------------------------------------------------------------------------------//
+int xQueueReceiveTimeout(xQueue* queue, void* item, uint32_t ticks)
+{
+	return queueReceive(queue, item, ticks, 0);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueSendFromISR
+//*DESCRIPTION: Copies an item to the back of the queue from an interrupt handler. Never blocks,
+//*and pends the context switch (see pendSwitch) if a woken receiver should preempt.
+//*INPUTS: Address of the Queue, Address of the item to copy in
+//*OUTPUTS: RTOS_OK once the item is queued, RTOS_FULL if the queue is full
+//------------------------------------------------------------------------------------------------//
+int xQueueSendFromISR(xQueue* queue, const void* item)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	int status = RTOS_FULL;
+	if(queue->count != queue->depth)
+	{
+		status = RTOS_OK;
+		if(queuePut(queue, item))
+		{
+			pendSwitch();
+		}
+	}
+	__set_PRIMASK(primask);
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueReceiveFromISR
+//*DESCRIPTION: Copies the oldest item out of the queue from an interrupt handler. Never blocks,
+//*and pends the context switch (see pendSwitch) if a woken sender should preempt.
+//*INPUTS: Address of the Queue, Address to copy the item out to
+//*OUTPUTS: RTOS_OK with the oldest item returned through the pointer, RTOS_TIMEOUT if the queue
+//*is empty
+//------------------------------------------------------------------------------------------------//
+int xQueueReceiveFromISR(xQueue* queue, void* item)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	int status = RTOS_TIMEOUT;
+	if(queue->count != 0)
+	{
+		status = RTOS_OK;
+		if(queueGet(queue, item))
+		{
+			pendSwitch();
+		}
+	}
+	__set_PRIMASK(primask);
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueSendBlock
+//*DESCRIPTION: Zero-copy send. Queues only the address of a block (see pvBlockAlloc), handing
+//*ownership of the block to the receiver. The queue must have been initialized with an item size
+//*of sizeof(void*).
+//*INPUTS: Address of the pointer Queue, Address of the block to send
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void xQueueSendBlock(xQueue* queue, void* block)
+{
+	xQueueSend(queue, &block);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xQueueReceiveBlock
+//*DESCRIPTION: Zero-copy receive. Takes ownership of the oldest block sent through a pointer
+//*queue, blocking while the queue is empty. The receiver frees the block when done with it.
+//*INPUTS: Address of the pointer Queue
+//*OUTPUTS: Address of the received block
+//------------------------------------------------------------------------------------------------//
+void* xQueueReceiveBlock(xQueue* queue)
+{
+	void* block;
+	xQueueReceive(queue, &block);
+	return block;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initBlockPool
+//*DESCRIPTION: Carves storage into num_blocks blocks and links them all onto the free list
+//*INPUTS: Address of the Block Pool, storage of num_blocks*block_size bytes (word aligned),
+//*bytes per block (at least sizeof(void*), rounded up to a multiple of 4), number of blocks
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initBlockPool(xBlockPool* pool, void* storage, uint32_t block_size, uint32_t num_blocks)
+{
+	block_size = (block_size + 3) & ~3u; //keep every block word aligned
+	pool->block_size = block_size;
+	pool->free_list = 0;
+	pool->free_count = num_blocks;
+	for(uint32_t i = num_blocks; i > 0; i--) //link in reverse so blocks are handed out in order
+	{
+		void** block = (void**)((uint8_t*)storage + (i-1)*block_size);
+		*block = pool->free_list;
+		pool->free_list = block;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: pvBlockAlloc
+//*DESCRIPTION: Pops a block off the pool's free list in O(1). Never blocks and restores the
+//*caller's interrupt mask, so it is safe from tasks, ISRs and critical sections alike.
+//*INPUTS: Address of the Block Pool
+//*OUTPUTS: Address of the allocated block, 0 if the pool is exhausted
+//------------------------------------------------------------------------------------------------//
+void* pvBlockAlloc(xBlockPool* pool)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	void** block = (void**)pool->free_list;
+	if(block != 0)
+	{
+		pool->free_list = *block;
+		pool->free_count--;
+	}
+	__set_PRIMASK(primask);
+	return block;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vBlockFree
+//*DESCRIPTION: Pushes a block back onto its pool's free list in O(1). Safe from tasks and ISRs.
+//*INPUTS: Address of the Block Pool, Address of a block allocated from it
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vBlockFree(xBlockPool* pool, void* block)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*(void**)block = pool->free_list;
+	pool->free_list = block;
+	pool->free_count++;
+	__set_PRIMASK(primask);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initEventGroup
+//*DESCRIPTION: initializes an event group with every flag bit clear
+//*INPUTS: Address of the Event Group
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initEventGroup(xEventGroup* group)
+{
+	group->bits = 0;
+	group->waiters.head = 0; //nobody blocked
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: eventSatisfied
+//*DESCRIPTION: Checks whether an event group's bits satisfy a wait for any or all of some bits
+//*INPUTS: Bits currently set, bits waited for, wait options
+//*OUTPUTS: 1 if the wait is satisfied, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int eventSatisfied(uint32_t set, uint32_t wanted, uint32_t options)
+{
+	if(options & EVENT_WAIT_ALL)
+	{
+		return (set & wanted) == wanted;
+	}
+	return (set & wanted) != 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: eventSet
+//*DESCRIPTION: Sets bits within an event group and wakes every waiting task whose wait is now
+//*satisfied, then clears the bits those tasks asked to clear on exit. Called with interrupts
+//*disabled.
+//*INPUTS: Address of the Event Group, bits to set
+//*OUTPUTS: 1 if a woken task should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int eventSet(xEventGroup* group, uint32_t bits)
+{
+	int preempt = 0;
+	uint32_t clear = 0;
+	group->bits |= bits & EVENT_BITS_MASK;
+
+	TaskControlBlock* task = group->waiters.head;
+	while(task != 0)
+	{
+		TaskControlBlock* next = task->wait_next;
+		if(eventSatisfied(group->bits, task->event_bits, task->event_options))
+		{
+			if(task->event_options & EVENT_CLEAR_ON_EXIT)
+			{
+				clear |= task->event_bits;
+			}
+			task->event_bits = group->bits; //report the bits that satisfied the wait
+			preempt |= wakeTask(task);
+		}
+		task = next;
+	}
+	group->bits &= ~clear;
+	return preempt;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xEventGroupWaitBits
+//*DESCRIPTION: Waits until any (or, with wait_all, every) one of the given bits is set within the
+//*event group, replacing a round-trip per condition through separate semaphores. With
+//*clear_on_exit the waited for bits are cleared once the wait is satisfied.
+//*INPUTS: Address of the Event Group, bits to wait for, clear bits on exit, wait for all bits,
+//*timeout in ticks (0 == do not block, WAIT_FOREVER)
+//*OUTPUTS: The group's bits when the wait was satisfied (before clearing), or the current bits if
+//*the timeout expired first
+//------------------------------------------------------------------------------------------------//
+uint32_t xEventGroupWaitBits(xEventGroup* group, uint32_t bits, bool clear_on_exit, bool wait_all,
+							 uint32_t ticks)
+{
+	uint32_t options = (wait_all ? EVENT_WAIT_ALL : 0) | (clear_on_exit ? EVENT_CLEAR_ON_EXIT : 0);
+	__disable_irq();
+	uint32_t set = group->bits;
+	if(eventSatisfied(set, bits, options))
+	{
+		if(clear_on_exit)
+		{
+			group->bits &= ~bits;
+		}
+		__enable_irq();
+		return set;
+	}
+	if(ticks == 0)
+	{
+		__enable_irq();
+		return set; //caller would rather not wait
+	}
+
+	CurrentTask->event_bits = bits & EVENT_BITS_MASK;
+	CurrentTask->event_options = options;
+	blockCurrent(&group->waiters, 0, ticks);
+	__enable_irq();
+	Yield();
+	if(CurrentTask->wake_status == RTOS_OK)
+	{
+		return CurrentTask->event_bits; //bits set when eventSet woke the task
+	}
+	return group->bits; //timed out
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xEventGroupSetBits
+//*DESCRIPTION: Sets bits within the event group, waking every task whose wait is satisfied and
+//*yielding if one of them should preempt the current task
+//*INPUTS: Address of the Event Group, bits to set
+//*OUTPUTS: The group's bits once satisfied waits have cleared theirs
+//------------------------------------------------------------------------------------------------//
+uint32_t xEventGroupSetBits(xEventGroup* group, uint32_t bits)
+{
+	__disable_irq();
+	int preempt = eventSet(group, bits);
+	uint32_t set = group->bits;
+	__enable_irq();
+	if(preempt)
+	{
+		Yield(); //invoke scheduler
+	}
+	return set;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xEventGroupClearBits
+//*DESCRIPTION: Clears bits within the event group
+//*INPUTS: Address of the Event Group, bits to clear
+//*OUTPUTS: The group's bits before they were cleared
+//------------------------------------------------------------------------------------------------//
+uint32_t xEventGroupClearBits(xEventGroup* group, uint32_t bits)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t set = group->bits;
+	group->bits = set & ~bits;
+	__set_PRIMASK(primask);
+	return set;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xEventGroupSetBitsFromISR
+//*DESCRIPTION: Sets bits within the event group from an interrupt handler, waking every task whose
+//*wait is satisfied and pending the context switch (see pendSwitch) if one should preempt
+//*INPUTS: Address of the Event Group, bits to set
+//*OUTPUTS: The group's bits once satisfied waits have cleared theirs
+//------------------------------------------------------------------------------------------------//
+uint32_t xEventGroupSetBitsFromISR(xEventGroup* group, uint32_t bits)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(eventSet(group, bits))
+	{
+		pendSwitch();
+	}
+	uint32_t set = group->bits;
+	__set_PRIMASK(primask);
+	return set;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: notifySend
+//*DESCRIPTION: Applies a notification action to a task's notification value and wakes the task if
+//*it is waiting for one. The target is known, so no wait list is searched. Called with interrupts
+//*disabled.
+//*INPUTS: Address of the target Task, value, action (NOTIFY_SET_BITS, NOTIFY_INCREMENT,
+//*NOTIFY_OVERWRITE, NOTIFY_NO_OVERWRITE)
+//*OUTPUTS: RTOS_FULL if NOTIFY_NO_OVERWRITE found a notification pending, otherwise 1 if the woken
+//*task should preempt the current task, 0 if not
+//------------------------------------------------------------------------------------------------//
+static int notifySend(TaskControlBlock* task, uint32_t value, int action)
+{
+	switch(action)
+	{
+	case NOTIFY_SET_BITS:
+		task->notify_value |= value;
+		break;
+	case NOTIFY_INCREMENT:
+		task->notify_value++;
+		break;
+	case NOTIFY_NO_OVERWRITE:
+		if(task->notify_state == NOTIFY_PENDING)
+		{
+			return RTOS_FULL; //previous notification not yet consumed
+		}
+		task->notify_value = value;
+		break;
+	default: //NOTIFY_OVERWRITE
+		task->notify_value = value;
+		break;
+	}
+
+	int waiting = (task->notify_state == NOTIFY_WAITING && task->blocked);
+	task->notify_state = NOTIFY_PENDING;
+	if(waiting)
+	{
+		return wakeTask(task);
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xTaskNotify
+//*DESCRIPTION: Sends a direct-to-task notification, a lightweight alternative to a semaphore or
+//*event group when the receiving task is known. Yields if the woken task should preempt.
+//*INPUTS: task (identifier given to CreateTask), value, action (NOTIFY_SET_BITS, NOTIFY_INCREMENT,
+//*NOTIFY_OVERWRITE, NOTIFY_NO_OVERWRITE)
+//*OUTPUTS: RTOS_OK, or RTOS_FULL if NOTIFY_NO_OVERWRITE found a notification pending
+//------------------------------------------------------------------------------------------------//
+int xTaskNotify(int task, uint32_t value, int action)
+{
+	__disable_irq();
+	int result = notifySend(&TCB[task], value, action);
+	__enable_irq();
+	if(result == RTOS_FULL)
+	{
+		return RTOS_FULL;
+	}
+	if(result)
+	{
+		Yield(); //invoke scheduler
+	}
+	return RTOS_OK;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xTaskNotifyGive
+//*DESCRIPTION: Increments a task's notification value, using it as a counting semaphore
+//*INPUTS: task (identifier given to CreateTask)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void xTaskNotifyGive(int task)
+{
+	xTaskNotify(task, 0, NOTIFY_INCREMENT);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xTaskNotifyFromISR
+//*DESCRIPTION: xTaskNotify for interrupt handlers, pending the context switch (see pendSwitch)
+//*rather than yielding
+//*INPUTS: task (identifier given to CreateTask), value, action (NOTIFY_SET_BITS, NOTIFY_INCREMENT,
+//*NOTIFY_OVERWRITE, NOTIFY_NO_OVERWRITE)
+//*OUTPUTS: RTOS_OK, or RTOS_FULL if NOTIFY_NO_OVERWRITE found a notification pending
+//------------------------------------------------------------------------------------------------//
+int xTaskNotifyFromISR(int task, uint32_t value, int action)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	int result = notifySend(&TCB[task], value, action);
+	if(result != RTOS_FULL && result)
+	{
+		pendSwitch();
+	}
+	__set_PRIMASK(primask);
+	return (result == RTOS_FULL) ? RTOS_FULL : RTOS_OK;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTaskNotifyGiveFromISR
+//*DESCRIPTION: Increments a task's notification value from an interrupt handler, the interrupt
+//*driven replacement for a task polling a flag
+//*INPUTS: task (identifier given to CreateTask)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTaskNotifyGiveFromISR(int task)
+{
+	xTaskNotifyFromISR(task, 0, NOTIFY_INCREMENT);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xTaskNotifyWait
+//*DESCRIPTION: Waits for a notification to the current task. Bits in clear_on_entry are cleared
+//*from the value before waiting (unless a notification is already pending) and bits in
+//*clear_on_exit once one is received.
+//*INPUTS: bits to clear on entry, bits to clear on exit, Address to return the value (or 0),
+//*timeout in ticks (0 == do not block, WAIT_FOREVER)
+//*OUTPUTS: RTOS_OK once notified, RTOS_TIMEOUT if the timeout expired first
+//------------------------------------------------------------------------------------------------//
+int xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, uint32_t ticks)
+{
+	TaskControlBlock* task = (TaskControlBlock*)CurrentTask;
+	__disable_irq();
+	if(task->notify_state != NOTIFY_PENDING)
+	{
+		task->notify_value &= ~clear_on_entry;
+		if(ticks != 0)
+		{
+			task->notify_state = NOTIFY_WAITING;
+			blockCurrent(0, 0, ticks);
+			__enable_irq();
+			Yield();
+			__disable_irq();
+		}
+	}
+
+	int status = (task->notify_state == NOTIFY_PENDING) ? RTOS_OK : RTOS_TIMEOUT;
+	if(value != 0)
+	{
+		*value = task->notify_value;
+	}
+	if(status == RTOS_OK)
+	{
+		task->notify_value &= ~clear_on_exit;
+	}
+	task->notify_state = NOTIFY_NONE;
+	__enable_irq();
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: ulTaskNotifyTake
+//*DESCRIPTION: Waits for the current task's notification value to become non-zero, then either
+//*decrements it (counting semaphore use) or clears it (binary semaphore use)
+//*INPUTS: clear value on exit (rather than decrement), timeout in ticks (0 == do not block,
+//*WAIT_FOREVER)
+//*OUTPUTS: The notification value before it was decremented or cleared, 0 on timeout
+//------------------------------------------------------------------------------------------------//
+uint32_t ulTaskNotifyTake(bool clear_on_exit, uint32_t ticks)
+{
+	TaskControlBlock* task = (TaskControlBlock*)CurrentTask;
+	__disable_irq();
+	if(task->notify_value == 0 && ticks != 0)
+	{
+		task->notify_state = NOTIFY_WAITING;
+		blockCurrent(0, 0, ticks);
+		__enable_irq();
+		Yield();
+		__disable_irq();
+	}
+
+	uint32_t value = task->notify_value;
+	if(value != 0)
+	{
+		task->notify_value = clear_on_exit ? 0 : value - 1;
+	}
+	task->notify_state = NOTIFY_NONE;
+	__enable_irq();
+	return value;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: timerUnlink
+//*DESCRIPTION: Removes a timer from the wheel slot (or expired list) holding it, clearing the slot's
+//*bitmap bit, and TimerSummary bit, once empty. O(1). Called with interrupts disabled.
+//*INPUTS: Address of the running Timer
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void timerUnlink(xTimer* timer)
+{
+	if(timer->prev != 0)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		*timer->list = timer->next;
+	}
+	if(timer->next != 0)
+	{
+		timer->next->prev = timer->prev;
+	}
+	if(*timer->list == 0 && timer->list != &TimerExpired)
+	{
+		if(timer->list >= TimerWheel && timer->list < &TimerWheel[TIMER_WHEEL_SLOTS])
+		{
+			uint32_t slot = timer->list - TimerWheel;
+			TimerBitmap[slot >> 5] &= ~(0x80000000u >> (slot & 31)); //slot now empty
+			if(TimerBitmap[slot >> 5] == 0)
+			{
+				TimerSummary &= ~(0x80000000u >> (slot >> 5));
+			}
+		}
+		else
+		{
+			uint32_t slot = timer->list - &TimerUpper[0][0];
+			TimerUpperBitmap[slot / TIMER_UPPER_SLOTS] &= ~(0x80000000u >> (slot % TIMER_UPPER_SLOTS));
+		}
+	}
+	timer->list = 0;
+	timer->next = 0;
+	timer->prev = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: timerLink
+//*DESCRIPTION: Hashes a timer into the wheel slot of its expiry tick, or straight onto the expired
+//*list if the timer service has already passed that tick. Timers due a rotation or more ahead go
+//*to the lowest upper level whose 32 slots reach their expiry, into the slot of the span holding
+//*it, whose earliest expiry is kept for timerNextDue. O(1): slots are not kept sorted, and the
+//*level is found in at most TIMER_UPPER_LEVELS steps. Called with interrupts disabled.
+//*INPUTS: Address of the stopped Timer
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void timerLink(xTimer* timer)
+{
+	int32_t ahead = (int32_t)(timer->expiry - TimerTick);
+	xTimer** list = &TimerExpired;
+	if(ahead >= TIMER_WHEEL_SLOTS)
+	{
+		uint32_t level = 0;
+		uint32_t spans = 0;
+		while(1)
+		{
+			uint32_t shift = TIMER_UPPER_SHIFT(level);
+			spans = ((timer->expiry >> shift) - (TimerTick >> shift)) & (0xFFFFFFFFu >> shift);
+			if(spans < TIMER_UPPER_SLOTS || level == TIMER_UPPER_LEVELS-1)
+			{
+				break; //spans is at least 1, the level below would have held the timer otherwise
+			}
+			level++;
+		}
+		uint32_t slot = (timer->expiry >> TIMER_UPPER_SHIFT(level)) & (TIMER_UPPER_SLOTS-1);
+		list = &TimerUpper[level][slot];
+		if(*list == 0 || (int32_t)(timer->expiry - TimerUpperFirst[level][slot]) < 0)
+		{
+			TimerUpperFirst[level][slot] = timer->expiry;
+		}
+		TimerUpperBitmap[level] |= 0x80000000u >> slot;
+	}
+	else if(ahead > 0)
+	{
+		uint32_t slot = timer->expiry & (TIMER_WHEEL_SLOTS-1);
+		list = &TimerWheel[slot];
+		TimerBitmap[slot >> 5] |= 0x80000000u >> (slot & 31);
+		TimerSummary |= 0x80000000u >> (slot >> 5);
+	}
+	timer->list = list;
+	timer->prev = 0;
+	timer->next = *list;
+	if(timer->next != 0)
+	{
+		timer->next->prev = timer;
+	}
+	*list = timer;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: timerNextSlot
+//*DESCRIPTION: Finds the next occupied wheel slot after TimerTick: the first set bit from that
+//*slot on within its TimerBitmap word, else the first word TimerSummary marks after it, wrapping
+//*round to the start of the wheel. At most two CLZ per level. Called with interrupts disabled.
+//*INPUTS: N/A
+//*OUTPUTS: Ticks from TimerTick to the next occupied slot (1 to TIMER_WHEEL_SLOTS), 0 if the wheel
+//*is empty
+//------------------------------------------------------------------------------------------------//
+static uint32_t timerNextSlot(void)
+{
+	if(TimerSummary == 0)
+	{
+		return 0;
+	}
+	uint32_t first = (TimerTick + 1) & (TIMER_WHEEL_SLOTS-1);
+	uint32_t word = first >> 5;
+	uint32_t bits = TimerBitmap[word] & (0xFFFFFFFFu >> (first & 31)); //slots from first on
+	if(bits == 0)
+	{
+		uint32_t later = (word < 31) ? TimerSummary & (0xFFFFFFFFu >> (word + 1)) : 0;
+		word = __CLZ((later != 0) ? later : TimerSummary); //wrap round once no later word is occupied
+		bits = TimerBitmap[word];
+	}
+	uint32_t slot = (word << 5) + __CLZ(bits);
+	return ((slot - first) & (TIMER_WHEEL_SLOTS-1)) + 1;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: timerNextUpper
+//*DESCRIPTION: Finds the next occupied slot of an upper level after the span holding TimerTick,
+//*with one or two CLZ of its TimerUpperBitmap word. Called with interrupts disabled.
+//*INPUTS: level (0 to TIMER_UPPER_LEVELS-1), its TimerUpperBitmap word must be non-zero
+//*OUTPUTS: Spans of the level from the one holding TimerTick to the slot (1 to TIMER_UPPER_SLOTS-1)
+//------------------------------------------------------------------------------------------------//
+static uint32_t timerNextUpper(uint32_t level)
+{
+	uint32_t current = (TimerTick >> TIMER_UPPER_SHIFT(level)) & (TIMER_UPPER_SLOTS-1);
+	uint32_t first = (current + 1) & (TIMER_UPPER_SLOTS-1);
+	uint32_t bits = TimerUpperBitmap[level] & (0xFFFFFFFFu >> first); //slots from first on
+	uint32_t slot = __CLZ((bits != 0) ? bits : TimerUpperBitmap[level]);
+	return (slot - current) & (TIMER_UPPER_SLOTS-1);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: timerNextDue
+//*DESCRIPTION: Ticks from TimerTick to the next tick a timer is due: the next occupied wheel slot,
+//*or the earliest expiry linked into the next occupied slot of an upper level, whichever comes
+//*first. A stopped timer may leave that earliest expiry behind, which only wakes the timer service
+//*once to no effect. Called with interrupts disabled.
+//*INPUTS: N/A
+//*OUTPUTS: Ticks to the next due timer, 0 if no timer is running
+//------------------------------------------------------------------------------------------------//
+static uint32_t timerNextDue(void)
+{
+	uint32_t ticks = timerNextSlot();
+	for(uint32_t level = 0; level < TIMER_UPPER_LEVELS; level++)
+	{
+		if(TimerUpperBitmap[level] == 0)
+		{
+			continue;
+		}
+		uint32_t shift = TIMER_UPPER_SHIFT(level);
+		uint32_t slot = ((TimerTick >> shift) + timerNextUpper(level)) & (TIMER_UPPER_SLOTS-1);
+		uint32_t due = TimerUpperFirst[level][slot] - TimerTick;
+		if(ticks == 0 || due < ticks)
+		{
+			ticks = due;
+		}
+	}
+	return ticks;
 }
 
 //------------------------------------------------------------------------------------------------//
-//*FUNCTION: initSemaphoreBinary
-//*DESCRIPTION: initializes a array of binary semaphore to untaken and assigns an index to each
-//*INPUTS: Beginning Address of a Semaphore Array (SemaphoreList) and the initial size of the array
+//*FUNCTION: timerAdvance
+//*DESCRIPTION: Advances TimerTick to now, stepping only through ticks a wheel slot is due on or an
+//*occupied upper slot's span starts on. The timers of each wheel slot reached move onto the expired
+//*list, those of each upper span entered cascade down to the wheel or a lower level. A timer
+//*cascades at most once per level, so expiry is O(1) per timer. Called with interrupts disabled.
+//*INPUTS: Current SystemTick
 //*OUTPUTS: N/A
 //------------------------------------------------------------------------------------------------//
-void initSemaphoreBinary(xSemaphore* SemaphoreList, int initialSize)
+static void timerAdvance(uint32_t now)
 {
-	//Initialize all values of given semaphore
-	for(int i = 0; i < initialSize; i++)
+	while(TimerTick != now)
 	{
-		SemaphoreList[i].Semaphore = false; //untaken initially
-		SemaphoreList[i].index = i;
+		uint32_t ahead = timerNextSlot();
+		for(uint32_t level = 0; level < TIMER_UPPER_LEVELS; level++)
+		{
+			if(TimerUpperBitmap[level] != 0)
+			{
+				uint32_t shift = TIMER_UPPER_SHIFT(level);
+				uint32_t start = ((TimerTick >> shift) + timerNextUpper(level)) << shift;
+				if(ahead == 0 || start - TimerTick < ahead)
+				{
+					ahead = start - TimerTick;
+				}
+			}
+		}
+		if(ahead == 0 || ahead > now - TimerTick)
+		{
+			TimerTick = now; //no timer due and no span entered up to now
+			break;
+		}
+		TimerTick += ahead;
+		xTimer** slot = &TimerWheel[TimerTick & (TIMER_WHEEL_SLOTS-1)];
+		while(*slot != 0)
+		{
+			xTimer* timer = *slot;
+			timerUnlink(timer);
+			timerLink(timer); //linked less than a rotation ahead, so due now: lands on the expired list
+		}
+		for(uint32_t level = 0; level < TIMER_UPPER_LEVELS; level++)
+		{
+			uint32_t shift = TIMER_UPPER_SHIFT(level);
+			if((TimerTick & ((1u << shift) - 1)) != 0)
+			{
+				break; //not the start of a span of this level, nor of any higher one
+			}
+			slot = &TimerUpper[level][(TimerTick >> shift) & (TIMER_UPPER_SLOTS-1)];
+			while(*slot != 0)
+			{
+				xTimer* timer = *slot;
+				timerUnlink(timer);
+				timerLink(timer); //within this span, so due now or on a lower level
+			}
+		}
 	}
 }
 
 //------------------------------------------------------------------------------------------------//
-//*FUNCTION: xSemaphoreTake
-//*DESCRIPTION: Take semaphore if available, otherwise block and identify the semaphore that
-//*blocks the current task by the semaphores index.
-//*INPUTS: Address of Semaphore to Take
-//*OUTPUTS: Task blocked or Semaphore Taken
+//*FUNCTION: timerService
+//*DESCRIPTION: Timer service task. Collects expired timers, runs their callbacks (restarting
+//*auto-reload timers from their previous expiry so they do not drift) and then sleeps until the
+//*next tick a timer is due, or until xTimerStart notifies it of an earlier expiry.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
 //------------------------------------------------------------------------------------------------//
-void xSemaphoreTake(xSemaphore* Semaphore)
+static void timerService(void)
 {
-	__disable_irq(); //disable interrupts
-	if(Semaphore->Semaphore == false)
+	while(1)
 	{
-		Semaphore->Semaphore = true;//Semaphore is free to take, so take it
-		//Set the field to say who took the semaphore (so that we can tell who is blocking)
-		__enable_irq();
+		__disable_irq();
+		timerAdvance(currentTick());
+		while(TimerExpired != 0)
+		{
+			xTimer* timer = TimerExpired;
+			timerUnlink(timer);
+			if(timer->auto_reload)
+			{
+				timer->expiry += timer->period;
+				timerLink(timer);
+			}
+			__enable_irq();
+			timer->callback(timer);
+			__disable_irq();
+		}
 
-	}
-	else //if we cannot take the semaphore, then block the task trying to take it
-	{	 //and identify the current task its blocked by
-		CurrentTask->blocked = 1;
-		CurrentTask->blockedby = Semaphore->index; //Set the semaphore identifier
+		uint32_t ticks = timerNextDue();
+		if(TimerTick != currentTick())
+		{
+			ticks = 0; //callbacks ran past a tick, catch up first
+		}
+		else if(ticks == 0)
+		{
+			ticks = WAIT_FOREVER; //no timer running
+		}
+		TimerIdle = (ticks == WAIT_FOREVER);
+		TimerWake = TimerTick + ticks;
 		__enable_irq();
-		Yield();
+		if(ticks != 0)
+		{
+			ulTaskNotifyTake(true, ticks);
+		}
 	}
 }
 
 //------------------------------------------------------------------------------------------------//
-//*FUNCTION: xSemaphoreGive
-//*DESCRIPTION: Releases the semaphore, an algorithm designed within decides if the semaphore is
-//*free or taken by another task that was previously blocked by it.
-//*INPUTS: Address of Semaphore to Give
-//*OUTPUTS: Semaphore Released or Taken by highest priority task blocked by the Semaphore.
+//*FUNCTION: initTimerService
+//*DESCRIPTION: Creates the timer service task that runs every software timer callback, replacing
+//*small periodic tasks and their stacks. Takes one of the NUM_TASKS task identifiers.
+//*INPUTS: task (identifier), stack (pre-allocated memory for the task), stack_words (size of the
+//*stack memory), priority of the task (callbacks run at this priority)
+//*OUTPUTS: N/A
 //------------------------------------------------------------------------------------------------//
-void xSemaphoreGive(xSemaphore* Semaphore)
+void initTimerService(int task, void *stack, uint32_t stack_words, int32_t priority)
 {
-	__disable_irq(); //disable interrupts
-
-
-//ALGORITHM PSUEDO CODE
-//Loop through all tasks and check the following:
-	//Is there somebody else waiting for the semaphore(i.e., blocked)? Thats not CurrentTask
-		//No - set semaphore to false (releasing the semaphore)
-		//Yes - unblock highest priority task waiting for the semaphore, leave semaphore to true
-	//Does the task unblockeds priority greater than the current tasks priority?
-		//Yes - Yield (i.e., invoke the scheduler to schedule that task)
-		//No - Return (your higher priority so continue running)
+	TimerTick = SystemTick;
+	TimerServiceTask = task;
+	CreateTask(task, timerService, stack, stack_words, priority);
+}
 
-	int j = NUM_TASKS+1; //index of highest priority task blocked by semaphore (if it exists)
-	for (int i = NUM_TASKS-1; i>0; i--)
-	{
-		//Check if there someone else blocked by this semaphore
-		if(TCB[i].blocked == 1 && TCB[i].blockedby == Semaphore->index)
-		{
-			//check in priority order
-			j = TCB[i].priority;
-		}
-	}
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initTimer
+//*DESCRIPTION: initializes a stopped software timer
+//*INPUTS: Address of the Timer, period in ticks (non-zero), auto-reload (periodic) or one-shot,
+//*callback run by the timer service on expiry, context (user data for the callback)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void initTimer(xTimer* timer, uint32_t period, bool auto_reload, void (*callback)(xTimer*), void* context)
+{
+	timer->next = 0;
+	timer->prev = 0;
+	timer->list = 0; //stopped
+	timer->expiry = 0;
+	timer->period = period;
+	timer->auto_reload = auto_reload;
+	timer->callback = callback;
+	timer->context = context;
+}
 
-	if(j == NUM_TASKS+1) //there were no blocked tasks
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: xTimerStart
+//*DESCRIPTION: Starts a timer, or restarts a running one, to expire period ticks from now. O(1)
+//*for any period (see timerLink), the timer service is only woken when the new expiry is earlier
+//*than it would otherwise wake.
+//*INPUTS: Address of the Timer
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void xTimerStart(xTimer* timer)
+{
+	__disable_irq();
+	if(timer->list != 0)
 	{
-		Semaphore->Semaphore=false;// give the semaphore
+		timerUnlink(timer);
 	}
-	else
+	timer->expiry = currentTick() + timer->period;
+	timerLink(timer);
+	bool wake = TimerIdle || (int32_t)(timer->expiry - TimerWake) < 0;
+	__enable_irq();
+	if(wake && TimerServiceTask != 0)
 	{
-		TCB[j].blocked = 0; //unblock the highest priority task waiting for the semaphore
-
-		//Check if the current task running or the newly unblocked task has higher priority
-		//If it does, invoke the scheduler and run the newly unblocked task
-		if(TCB[j].priority < CurrentTask->priority)
-		{
-			Semaphore->Semaphore=true; 	//keep the semaphore blocked, since the newly unblocked task will take it
-			__enable_irq(); 			//enable interrupts
-			Yield(); 					//invoke scheduler
-		}
-		//Continue running the current task since our priority is higher than the unblocked task priority
+		xTaskNotifyGive(TimerServiceTask); //sleep is too long, recompute it
 	}
-	__enable_irq();
 }
 
 //------------------------------------------------------------------------------------------------//
-//*FUNCTION: vTaskDelayUntil
-//*DESCRIPTION: delays scheduler from scheduling the current task until a user defined release
-//*time relative to the system tick. updates the next release time based off of the period
-//*INPUTS: Pointer to the tasks release_time and period as defined by user.
-//*OUTPUTS:
+//*FUNCTION: xTimerStop
+//*DESCRIPTION: Stops a running timer so its callback does not run. O(1).
+//*INPUTS: Address of the Timer
+//*OUTPUTS: N/A
 //------------------------------------------------------------------------------------------------//
-void vTaskDelayUntil(int* release_time, int period)
+void xTimerStop(xTimer* timer)
 {
-	CurrentTask->suspend = *release_time; //Current Task won't be released until suspend > sysTick
-	*release_time += period; //Update the tasks next release time based off of tasks period
-	Yield(); //invoke the scheduler
+	__disable_irq();
+	if(timer->list != 0)
+	{
+		timerUnlink(timer);
+	}
+	__enable_irq();
 }
 
 //------------------------------------------------------------------------------------------------//
 //*FUNCTION: initMailbox
-//*DESCRIPTION: initializes mailbox semaphores and their associated indicies
-//*INPUTS: Address of the Mailbox and starting semaphore index
+//*DESCRIPTION: initializes the mailbox queue, which holds up to MAILBOX_DEPTH values
+//*INPUTS: Address of the Mailbox and starting semaphore index (unused, mailboxes no longer use
+//*semaphores)
 //*OUTPUTS: N/A
 //------------------------------------------------------------------------------------------------//
 void initMailbox(xMailbox *box, int index)
 {
-	//Initialize all values
-	box->sem_Data.Semaphore = true; //No data initially in the mailbox
-	box->sem_Data.index = index; //used for a list of semaphores, unused here
-	box->sem_Space.Semaphore = false; //initialized to false, there is space in the mailbox
-	box->sem_Space.index = index+1; //used for a list of semaphores, unused here
+	(void)index;
+	initQueue(&box->queue, box->the_data, sizeof(int), MAILBOX_DEPTH);
 }
 
 //------------------------------------------------------------------------------------------------//
 //*FUNCTION: writeToBox
 //*DESCRIPTION: checks to see if there is space available in the mailbox,
-//*writes data to the mailbox if there is, else blocks until mailbox is released.
+//*writes data to the mailbox if there is, else blocks until a value is read.
 //*INPUTS: Address of Mailbox, Address of data to store within mailbox
 //*OUTPUTS: N/A
 //------------------------------------------------------------------------------------------------//
 void writeToBox(xMailbox *box, int* stored_data)
 {
-	xSemaphoreTake(&box->sem_Space); //Check Mailbox Status
-	box->the_data = *stored_data;	 //Write Data to Mailbox
-	xSemaphoreGive(&box->sem_Data);  //State Mailbox is Full
+	writeToBoxTimeout(box, stored_data, WAIT_FOREVER); //Write Data to Mailbox
 }
 
 //------------------------------------------------------------------------------------------------//
 //*FUNCTION: readFromBox
 //*DESCRIPTION: Checks to see if there is data to be read from the box,
-//*returns data if there data in the mailbox, blocks if otherwise.
+//*returns the oldest value if there data in the mailbox, blocks if otherwise.
 //*INPUTS: Address of Mailbox, Address of place to return data through
 //*OUTPUTS: returns (through a pointer) the data stored in the mailbox
 //------------------------------------------------------------------------------------------------//
 void readFromBox(xMailbox *box, int* returned_data)
 {
-	xSemaphoreTake(&box->sem_Data); //Check if Mailbox has Data
-	*returned_data = box->the_data; //Read Data from Mailbox
-	xSemaphoreGive(&box->sem_Space);//State Mailbox is now Empty
+	readFromBoxTimeout(box, returned_data, WAIT_FOREVER); //Read Data from Mailbox
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: writeToBoxTimeout
+//*DESCRIPTION: writeToBox that gives up once the mailbox stays full for ticks SystemTicks
+//*INPUTS: Address of Mailbox, Address of data to store within mailbox, timeout in ticks
+//*OUTPUTS: RTOS_OK once written, RTOS_TIMEOUT if the mailbox stayed full
+//------------------------------------------------------------------------------------------------//
+int writeToBoxTimeout(xMailbox *box, int* stored_data, uint32_t ticks)
+{
+	return queueSend(&box->queue, stored_data, ticks, box); //records the write
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: readFromBoxTimeout
+//*DESCRIPTION: readFromBox that gives up once the mailbox stays empty for ticks SystemTicks
+//*INPUTS: Address of Mailbox, Address of place to return data through, timeout in ticks
+//*OUTPUTS: RTOS_OK with the data returned through the pointer, RTOS_TIMEOUT if the mailbox
+//*stayed empty
+//------------------------------------------------------------------------------------------------//
+int readFromBoxTimeout(xMailbox *box, int* returned_data, uint32_t ticks)
+{
+	return queueReceive(&box->queue, returned_data, ticks, box); //records the read
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: writeToBoxFromISR
+//*DESCRIPTION: writeToBox for interrupt handlers, never blocks
+//*INPUTS: Address of Mailbox, Address of data to store within mailbox
+//*OUTPUTS: RTOS_OK once written, RTOS_FULL if the mailbox is full
+//------------------------------------------------------------------------------------------------//
+int writeToBoxFromISR(xMailbox *box, int* stored_data)
+{
+	int status = xQueueSendFromISR(&box->queue, stored_data);
+	if(status == RTOS_OK)
+	{
+		TRACE_EVENT(TRACE_EVT_MBOX_WRITE, TRACE_OBJECT(box));
+	}
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: readFromBoxFromISR
+//*DESCRIPTION: readFromBox for interrupt handlers, never blocks
+//*INPUTS: Address of Mailbox, Address of place to return data through
+//*OUTPUTS: RTOS_OK with the data returned through the pointer, RTOS_TIMEOUT if the mailbox is
+//*empty
+//------------------------------------------------------------------------------------------------//
+int readFromBoxFromISR(xMailbox *box, int* returned_data)
+{
+	int status = xQueueReceiveFromISR(&box->queue, returned_data);
+	if(status == RTOS_OK)
+	{
+		TRACE_EVENT(TRACE_EVT_MBOX_READ, TRACE_OBJECT(box));
+	}
+	return status;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: uxTaskGetBoostTicks
+//*DESCRIPTION: Reports how long a task has run with a priority inherited from a blocked task,
+//*including a boost still in progress
+//*INPUTS: task (identifier given to CreateTask)
+//*OUTPUTS: Total SystemTicks spent boosted
+//------------------------------------------------------------------------------------------------//
+uint32_t uxTaskGetBoostTicks(int task)
+{
+	__disable_irq();
+	uint32_t ticks = TCB[task].boost_ticks;
+	if(taskBoosted(&TCB[task]))
+	{
+		ticks += currentTick() - TCB[task].boost_start;
+	}
+	__enable_irq();
+	return ticks;
+}
+
+#if STACK_PAINT
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: stackMeasure
+//*DESCRIPTION: Counts the painted words left at the bottom of a task stack. Usage only grows, so
+//*the scan stops at the previous high-water mark and the cost shrinks as the mark settles.
+//*INPUTS: Address of the Task
+//*OUTPUTS: Fewest stack words left unused, 0 if the stack has been used to its base (overflow)
+//------------------------------------------------------------------------------------------------//
+static uint32_t stackMeasure(TaskControlBlock* task)
+{
+	uint32_t free = 0;
+	while(free < task->stack_free && task->stack_base[free] == STACK_PAINT_PATTERN)
+	{
+		free++;
+	}
+	task->stack_free = free;
+	return free;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: uxTaskGetStackHighWaterMark
+//*DESCRIPTION: Reports the fewest stack words a task has left unused since it was created, used to
+//*right-size task stacks. Requires STACK_PAINT.
+//*INPUTS: task (identifier given to CreateTask)
+//*OUTPUTS: Stack words never used, 0 if the task has used its whole stack
+//------------------------------------------------------------------------------------------------//
+uint32_t uxTaskGetStackHighWaterMark(int task)
+{
+#if STACK_PAINT
+	return stackMeasure(&TCB[task]);
+#else
+	(void)task;
+	return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTaskStackScan
+//*DESCRIPTION: Low-cost background check called from the idle loop. Each call measures the stack
+//*of one task in turn, keeping every task's high-water mark current without a full sweep.
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTaskStackScan(void)
+{
+#if STACK_PAINT
+	static int next = 1; //TCB[0] is the idle loop running on the main stack
+	if(TCB[next].stack_base != 0)
+	{
+		stackMeasure(&TCB[next]);
+	}
+	next = (next + 1 == NUM_TASKS) ? 1 : next + 1;
+#endif
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: taskRunTime
+//*DESCRIPTION: DWT cycles a task has run, including the slice in progress if it is the current
+//*task. context.s only charges a task when it is switched out. Called with interrupts disabled.
+//*INPUTS: Address of the Task
+//*OUTPUTS: DWT cycles run (wraps at 2^32)
+//------------------------------------------------------------------------------------------------//
+static uint32_t taskRunTime(TaskControlBlock* task)
+{
+	uint32_t runtime = task->runtime;
+	if(task == (TaskControlBlock*)CurrentTask)
+	{
+		runtime += portCycleCount() - RunTimeStamp;
+	}
+	return runtime;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vRunTimeWindowStart
+//*DESCRIPTION: Starts a new CPU utilization window for every task, including the idle loop
+//*(TCB[0]). Windows must be shorter than 2^32 core clock cycles (about 89 seconds at 48 MHz).
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vRunTimeWindowStart(void)
+{
+	__disable_irq();
+	for(int i = 0; i < NUM_TASKS; i++)
+	{
+		TCB[i].window_runtime = taskRunTime(&TCB[i]);
+		TCB[i].window_switches = TCB[i].switches;
+	}
+	WindowStart = portCycleCount();
+	__enable_irq();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: ulTaskGetRunTime
+//*DESCRIPTION: Reports the total DWT cycles a task has spent running. Interrupt handlers are
+//*charged to the task they interrupted.
+//*INPUTS: task (identifier given to CreateTask, 0 == idle loop)
+//*OUTPUTS: DWT cycles run (wraps at 2^32)
+//------------------------------------------------------------------------------------------------//
+uint32_t ulTaskGetRunTime(int task)
+{
+	__disable_irq();
+	uint32_t runtime = taskRunTime(&TCB[task]);
+	__enable_irq();
+	return runtime;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: uxTaskGetUtilization
+//*DESCRIPTION: Reports the share of the CPU a task has used since vRunTimeWindowStart and how
+//*often it was switched in, the basis for capacity planning
+//*INPUTS: task (identifier given to CreateTask, 0 == idle loop), Address to return the number of
+//*context switches into the task within the window (or 0)
+//*OUTPUTS: CPU utilization within the window in hundredths of a percent (10000 == 100%)
+//------------------------------------------------------------------------------------------------//
+uint32_t uxTaskGetUtilization(int task, uint32_t* switches)
+{
+	__disable_irq();
+	uint32_t runtime = taskRunTime(&TCB[task]) - TCB[task].window_runtime;
+	uint32_t window = portCycleCount() - WindowStart;
+	if(switches != 0)
+	{
+		*switches = TCB[task].switches - TCB[task].window_switches;
+	}
+	__enable_irq();
+	if(window == 0)
+	{
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)runtime * 10000) / window);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vLatencyHistogramRead
+//*DESCRIPTION: Copies one latency histogram in a single consistent snapshot, optionally clearing
+//*it to start a new measurement. Latencies are in cycles of the port's cycle counter.
+//*INPUTS: kind (LATENCY_INTERRUPT, LATENCY_RELEASE or LATENCY_SEMAPHORE), Address to copy the
+//*histogram to, reset (clear the histogram once copied)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vLatencyHistogramRead(int kind, xLatencyHistogram* histogram, bool reset)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	*histogram = LatencyHistogram[kind];
+	if(reset)
+	{
+		memset(&LatencyHistogram[kind], 0, sizeof(xLatencyHistogram));
+	}
+	__set_PRIMASK(primask);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: releaseDelayed
+//*DESCRIPTION: Moves delayed tasks whose suspend time has been reached onto the ready queue. Only
+//*the head of the delta queue is checked, so the cost is O(1) when nothing is due and O(k) for k
+//*tasks released on the same tick (deltas of 0). A task still blocked on a kernel object has
+//*timed out, so it also leaves that object's wait list.
+//*INPUTS: N/A
+//*OUTPUTS: 1 if a released task should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int releaseDelayed(void)
+{
+	int preempt = 0;
+	while(DelayedList != 0 && (int32_t)(SystemTick - NextRelease) >= 0)
+	{
+		TaskControlBlock* task = DelayedList;
+		DelayedList = task->next;
+		if(DelayedList != 0)
+		{
+			DelayedList->prev = 0;
+			NextRelease += DelayedList->delta; //re-anchor the new head at its absolute release
+			DelayedList->delta = 0;
+		}
+		task->next = 0;
+		task->delayed = 0;
+
+		xSemaphore* blockedby = task->blockedby;
+		if(task->blocked == 1) //wait timed out
+		{
+			waitRemove(task);
+			task->blocked = 0;
+			task->blockedby = 0;
+			task->wake_status = RTOS_TIMEOUT;
+		}
+		else
+		{
+			latencyStart(task, LATENCY_RELEASE); //released at its suspend time
+		}
+		readyInsert(task); //release time reached
+		preempt |= preemptsCurrent(task);
+		if(blockedby != 0 && blockedby->owner != 0)
+		{
+			refreshPrecedence(blockedby->owner); //the owner no longer inherits from this task
+		}
+	}
+	return preempt;
+}
+
+#if TICKLESS
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: tickReprogram
+//*DESCRIPTION: Credits SystemTick with every tick boundary passed since the running period started,
+//*releases due tasks and restarts SysTick so its next interrupt lands exactly on the earliest
+//*suspend time (or the longest period SysTick can count). SysTick keeps counting throughout: the
+//*cycles it ran while tasks were released are read back before the reload, and the fixed cost of
+//*the reload itself (TICKLESS_RELOAD_CYCLES) is taken off the new period, so the fraction of a
+//*tick carried in TicklessPhase loses no time. Called with interrupts disabled.
+//*INPUTS: N/A
+//*OUTPUTS: 1 if a released task should preempt the current task, 0 otherwise
+//------------------------------------------------------------------------------------------------//
+static int tickReprogram(void)
+{
+	uint32_t count = SysTick->VAL;			//read before the pending flag so a wrap in between is seen
+	if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)	//period ended, interrupt not yet serviced
+	{
+		SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+		SystemTick += TicklessPeriod;
+		TicklessPhase = 0;
+		count = SysTick->VAL; //counter reloaded, read it again
+	}
+	int32_t cycles = TicklessPhase + (int32_t)(SysTick->LOAD - count) + 1; //+1 for the reload cycle
+	int preempt = 0;
+	uint32_t ticks;
+	while(1)
+	{
+		//Credit whole ticks elapsed in the running period and keep the remainder as the new phase
+		SystemTick += cycles / (int32_t)CyclesPerTick;
+		TicklessPhase = cycles % (int32_t)CyclesPerTick;
+		if(TicklessPhase > (int32_t)(CyclesPerTick - TICKLESS_MIN_CYCLES))
+		{
+			SystemTick++; //next boundary is too close to program, take it now
+			TicklessPhase -= (int32_t)CyclesPerTick;
+		}
+		preempt |= releaseDelayed();
+
+		//Sleep until the earliest suspend time, releaseDelayed guarantees it is in the future
+		ticks = TicklessMaxTicks;
+		if(DelayedList != 0 && NextRelease - SystemTick < ticks)
+		{
+			ticks = NextRelease - SystemTick;
+		}
+
+		//Add the cycles the counter ran since it was read
+		uint32_t now = SysTick->VAL;
+		int32_t ran = (int32_t)(count - now);
+		if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) //counted past the end of the running period
+		{
+			SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+			now = SysTick->VAL;
+			ran = (int32_t)(count + 1 + SysTick->LOAD - now);
+		}
+		cycles = TicklessPhase + ran;
+		if(cycles + TICKLESS_RELOAD_CYCLES <= (int32_t)(ticks*CyclesPerTick - TICKLESS_MIN_CYCLES))
+		{
+			break;
+		}
+		count = now; //releasing took the counter past the next boundary, catch up again
+	}
+	TicklessPeriod = ticks;
+	TicklessTarget = SystemTick + ticks;
+	TicklessPhase = cycles + TICKLESS_RELOAD_CYCLES;
+	SysTick->LOAD = ticks*CyclesPerTick - TicklessPhase - 1;
+	SysTick->VAL = 0; //reload, the period starts TICKLESS_RELOAD_CYCLES after now was read
+	return preempt;
+}
+#endif
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: initSystemTick
+//*DESCRIPTION: Configures SysTick for a SystemTick of cycles_per_tick core clock cycles. With
+//*TICKLESS enabled SysTick is reprogrammed on every interrupt to fire only at the next release.
+//*INPUTS: Core clock cycles per SystemTick (e.g. SystemCoreClock/1000 for 1ms)
+//*OUTPUTS: 0 on success, non-zero if SysTick cannot count cycles_per_tick
+//------------------------------------------------------------------------------------------------//
+int initSystemTick(uint32_t cycles_per_tick)
+{
+	if(portInitTick(cycles_per_tick)) //SysTick, lowest priority PendSV and the cycle counter
+	{
+		return 1;
+	}
+	RunTimeStamp = portCycleCount();
+	WindowStart = RunTimeStamp;
+	TCB[0].latency_kind = LATENCY_NONE; //the idle loop is never created by CreateTask
+#if TICKLESS
+	__disable_irq();
+	CyclesPerTick = cycles_per_tick;
+	TicklessMaxTicks = SysTick_LOAD_RELOAD_Msk / cycles_per_tick - 1;
+	if(TicklessMaxTicks == 0)
+	{
+		TicklessMaxTicks = 1;
+	}
+	TicklessPeriod = 1; //SysTick_Config started a single tick period on a tick boundary
+	TicklessTarget = SystemTick + 1;
+	TicklessPhase = 0;
+	__enable_irq();
+#endif
+	return 0;
 }
 
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: TickIncrement
+//*DESCRIPTION: Called from the systick handler inside context.s with interrupts disabled, which then
+//*decides whether to pend the context switch. Increments the SystemTick and, only once the
+//*earliest suspend time is reached, moves expired delayed tasks to the ready queue. Most ticks
+//*release nothing, so the handler returns without saving or switching any task context.
+//*In TICKLESS mode the interrupt marks the end of a multi-tick period instead of a single tick.
+//*INPUTS: N/A
+//*OUTPUTS: 1 if a released task should preempt the current task (pend the switch), 0 otherwise
+//------------------------------------------------------------------------------------------------//
+int TickIncrement(void)
+{
+#if TICKLESS
+	SystemTick += TicklessPeriod; //SysTick period ended exactly on a tick boundary
+	TicklessPhase = 0;
+	TRACE_EVENT(TRACE_EVT_TICK, SystemTick);
+	return tickReprogram();
+#else
+	SystemTick++;
+	TRACE_EVENT(TRACE_EVT_TICK, SystemTick);
+	if(DelayedList == 0 || (int32_t)(SystemTick - NextRelease) < 0)
+	{
+		return 0; //fast path: nothing due
+	}
+	return releaseDelayed();
+#endif
+}
 
 //------------------------------------------------------------------------------------------------//
 //*FUNCTION: Scheduler
-//*DESCRIPTION: Called from the svc handler or systick handler inside context.asm,
+//*DESCRIPTION: Called from the pendsv handler inside context.s with interrupts disabled,
 //*returns the address of the next task to be scheduled
 //*INPUTS: N/A
 //*OUTPUTS: Address of task to be scheduled
@@ -215,17 +2686,36 @@ void readFromBox(xMailbox *box, int* returned_data)
 // Called in an interrupt context to select next task to run
 TaskControlBlock* scheduler(void) //return type pointer
 {
-	//Execute Tasks in order of priority (based on position within the task control block (TCB))
-	//1. if the task is available
-	//2. if the task has not been blocked by a semaphore
-	for (int i = 1; i < NUM_TASKS; i++)
+#if TICKLESS
+	//A task delayed with a release earlier than the programmed SysTick period needs SysTick
+	//reprogrammed, which also catches up SystemTick and releases the task if it is already due
+	if(TicklessPeriod != 0 && DelayedList != 0 && (int32_t)(NextRelease - TicklessTarget) < 0)
 	{
-		if (SystemTick >= TCB[i].suspend && TCB[i].blocked == 0)
-		{
-			return TCB+i; //return address of task to be scheduled
-		}
+		tickReprogram();
 	}
+#endif
+
 	//return TCB (address of first element in task control block)
-	return TCB; //If no task is released, conduct Aperiodic jobs
+	TaskControlBlock* next = TCB; //If no task is released, conduct Aperiodic jobs
+#if SCHEDULER == SCHED_EDF
+	//Execute the ready task with the earliest deadline, always held at the root of the heap
+	if (ReadyHeapSize != 0)
+	{
+		next = ReadyHeap[0];
+	}
+#else
+	//Execute the task at the head of the highest priority non-empty ready list. Bit 31 of the
+	//ready bitmap is priority 0, so the count of leading zeros is the highest ready priority.
+	//Tasks only enter the ready lists once released and unblocked (see readyInsert)
+	if (ReadyBitmap != 0)
+	{
+		next = ReadyList[__CLZ(ReadyBitmap)];
+	}
+#endif
+	if(next != (TaskControlBlock*)CurrentTask)
+	{
+		TRACE_EVENT(TRACE_EVT_SWITCH, next->task);
+	}
+	latencyDispatch(next); //also a task released again before it was switched out
+	return next; //return address of task to be scheduled
 }
-
@@ -23,7 +23,59 @@
 #ifndef MYRTOS_H_
 #define MYRTOS_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef NUM_TASKS
 #define NUM_TASKS 5 //Hard Coded Number of Real-Time Tasks, (always NUM_TASKS-1)
+#endif
+#define MAX_PRIORITIES 32 //Number of priority levels (0..31), one bit per level in the ready bitmap
+#define SCHED_FIXED_PRIORITY 0 //Run the highest priority ready task (lower num = higher priority)
+#define SCHED_EDF 1 //Run the ready task with the Earliest absolute Deadline First
+#ifndef SCHEDULER
+#define SCHEDULER SCHED_FIXED_PRIORITY //Ready queue policy, SCHED_FIXED_PRIORITY or SCHED_EDF
+#endif
+#ifndef TICKLESS
+#define TICKLESS 1 //1 == SysTick only interrupts at the next release, 0 == SysTick interrupts every tick
+#endif
+#define MAILBOX_DEPTH 4 //Values a mailbox holds before writeToBox blocks
+#ifndef TIMER_WHEEL_SLOTS
+#define TIMER_WHEEL_SLOTS 32 //Software timer wheel slots (power of 2, 32 to 1024), ticks of one rotation
+#endif
+#ifndef STACK_PAINT
+#define STACK_PAINT 1 //1 == CreateTask paints task stacks so their high-water marks can be measured
+#endif
+#define STACK_PAINT_PATTERN 0xA5A5A5A5u //Word written over unused stack memory
+#define STACK_SCAN_INTERVAL 0x3FF //Idle loop iterations between vTaskStackScan calls (power of 2, -1)
+#ifndef LATENCY_HISTOGRAMS
+#define LATENCY_HISTOGRAMS 1 //1 == wake-to-dispatch latencies are recorded into log2 histograms
+#endif
+#define LATENCY_BUCKETS 24 //bucket b counts latencies of 2^(b-1) to 2^b-1 cycles, the last one more
+
+//Kernel Return Codes
+#define RTOS_OK 0	 //Kernel call completed
+#define RTOS_FULL -1 //Kernel object already at capacity
+#define RTOS_TIMEOUT -2 //Timeout expired before the kernel object became available
+#define WAIT_FOREVER 0xFFFFFFFFu //Timeout (in ticks) that never expires
+
+#define EVENT_BITS_MASK 0x00FFFFFFu //Flag bits usable within an event group (24)
+
+//Actions xTaskNotify applies to the target task's notification value
+#define NOTIFY_SET_BITS 0			//OR the given bits into the value
+#define NOTIFY_INCREMENT 1			//Add one to the value (counting semaphore use)
+#define NOTIFY_OVERWRITE 2			//Replace the value
+#define NOTIFY_NO_OVERWRITE 3		//Replace the value unless a notification is still pending
+
+//Latency histograms, each measured from the event to the woken task being switched in
+#define LATENCY_INTERRUPT 0			//Task woken by a FromISR call (ISR give -> task running)
+#define LATENCY_RELEASE 1			//Task released at its suspend time (release -> dispatch)
+#define LATENCY_SEMAPHORE 2			//Semaphore handed from a task to a waiter (give -> waiter running)
+#define LATENCY_KINDS 3
+#define LATENCY_NONE -1				//Wake not measured
+
+//Overrun policies of vTaskDelayUntil, applied when a job completes after its deadline
+#define DEADLINE_CATCH_UP 0			//Release every missed job, back to back, until on time again
+#define DEADLINE_SKIP 1				//Drop releases whose deadline already passed, run the latest one
 
 
 //------------------------------------------------------------------------------------------------//
@@ -31,40 +83,144 @@
 //------------------------------------------------------------------------------------------------//
 
 
+//STRUCT: xWaitList
+//DESCRIPTION: intrusive list of the tasks blocked on a kernel object, highest precedence first
+typedef struct {
+	struct TaskControlBlock *head; //highest precedence blocked task, 0 == nobody is blocked
+} xWaitList;
+
 //STRUCT: TaskControlBlock
 //DESCRIPTION: struct containing all task associated parameters, such as priority, blocked, etc.
-typedef struct
+typedef struct TaskControlBlock
 {
 	uint32_t *stack_pointer; 	//points to allocated task stack memory
+	uint32_t runtime;			//DWT cycles spent running, accumulated by context.s (offset 4)
+	uint32_t switches;			//times the task was switched in, counted by context.s (offset 8)
 	int32_t suspend;			//suspend time till tasks next release
 	int32_t priority;			//tasks priority level (lower num = higher priority)
 	int32_t blocked; 			//task is blocked: 0 == false, 1 == true
-	int blockedby;				//index of the semaphore blocking the task
+	struct xSemaphore *blockedby; //semaphore blocking the task, 0 == nobody is blocking
 	int task; 					//index of task - for location within a TCB Array
+	struct TaskControlBlock *next; //next task in the ready or delayed list holding this task
+	struct TaskControlBlock *prev; //previous task in the ready or delayed list holding this task
+	uint32_t delta;				//ticks between this release and the previous task in the delayed list
+	int32_t period;				//release period set by vTaskDelayUntil, 0 == aperiodic task
+	uint32_t deadline;			//absolute deadline of the current job (release + period)
+	int heap_index;				//position within the EDF ready heap
+	int32_t ready;				//task is within the ready queue: 0 == false, 1 == true
+	int32_t delayed;			//task is within the delayed list: 0 == false, 1 == true
+	int32_t wake_status;		//RTOS_OK when woken by a kernel object, RTOS_TIMEOUT on timeout
+	uint32_t event_bits;		//event bits waited for, then the group's bits when woken
+	uint32_t event_options;		//event wait options: wait for all bits, clear bits on exit
+	volatile uint32_t notify_value;	//direct-to-task notification value
+	volatile int32_t notify_state;	//no notification, waiting for one, or one pending
+	int32_t base_priority;		//priority assigned by CreateTask, restored once no longer boosted
+	int32_t base_period;		//period set by vTaskDelayUntil, restored once no longer boosted
+	uint32_t base_deadline;		//deadline set by vTaskDelayUntil, restored once no longer boosted
+	struct xSemaphore *held;	//inheritance semaphores currently held by the task
+	uint32_t boost_start;		//SystemTick when the task was last boosted by priority inheritance
+	uint32_t boost_ticks;		//total SystemTicks spent boosted by priority inheritance
+	xWaitList *waitlist;		//wait list holding the task while blocked, 0 == not waiting
+	struct TaskControlBlock *wait_next; //next (lower precedence) task within the wait list
+	struct TaskControlBlock *wait_prev; //previous (higher precedence) task within the wait list
+	uint32_t *stack_base;		//lowest word of the task stack, 0 == no stack (idle loop)
+	uint32_t stack_words;		//size of the task stack in words
+	uint32_t stack_free;		//fewest stack words ever left unused (high-water mark)
+	uint32_t window_runtime;	//runtime when the measurement window started
+	uint32_t window_switches;	//switches when the measurement window started
+	uint32_t latency_stamp;		//cycle count when the task was last woken or released
+	int32_t latency_kind;		//LATENCY_ histogram the pending dispatch is recorded into
+	int32_t deadline_policy;	//DEADLINE_CATCH_UP or DEADLINE_SKIP after an overrun
+	uint32_t deadline_misses;	//jobs completed after their deadline (vTaskDelayUntil)
+	uint32_t skipped_releases;	//releases dropped by DEADLINE_SKIP
 } TaskControlBlock;
 
 //STRUCT: xSemaphore
 //DESCRIPTION:
-typedef struct {
+typedef struct xSemaphore {
   bool Semaphore;				//Binary semaphore: false == untaken, true == taken
-  int index; 					//index of Semaphore - for location within Semaphore Array
+  int index; 					//index of Semaphore - for location within Semaphore Array (informational)
+  xWaitList waiters;			//Tasks blocked by the semaphore in precedence order
+  bool inherit;					//Owner inherits the priority of waiters (mutual exclusion use)
+  TaskControlBlock *owner;		//Task holding the semaphore (inherit only), 0 == untaken
+  struct xSemaphore *held_next;	//Next semaphore held by the same owner
 } xSemaphore;
 
+//STRUCT: xSemaphoreCounting
+//DESCRIPTION: Counting semaphore guarding up to max_count identical resources (buffer slots, etc.)
+typedef struct {
+	volatile uint32_t count;	//Units available to take
+	uint32_t max_count;			//Most units the semaphore can hold
+	xWaitList waiters;			//Tasks blocked until a unit is given, in precedence order
+} xSemaphoreCounting;
+
+//STRUCT: xQueue
+//DESCRIPTION: Fixed capacity FIFO message queue of depth items of item_size bytes each, copied
+//in and out of caller provided storage (depth*item_size bytes)
+typedef struct {
+	uint8_t *storage;			//Ring buffer holding the queued items
+	uint32_t item_size;			//Bytes copied per item
+	uint32_t depth;				//Most items the queue can hold
+	uint32_t head;				//Slot of the oldest item (next to receive)
+	uint32_t tail;				//Slot the next item is sent into
+	uint32_t count;				//Items currently queued
+	xWaitList senders;			//Tasks blocked while the queue is full
+	xWaitList receivers;		//Tasks blocked while the queue is empty
+} xQueue;
+
+//STRUCT: xBlockPool
+//DESCRIPTION: Pool of equally sized memory blocks for zero-copy message passing. Producers
+//allocate a block, fill it and send its address through an xQueue of pointers; the consumer
+//owns the block once received and frees it back to the pool.
+typedef struct {
+	void *free_list;			//First free block, each free block holds the address of the next
+	uint32_t block_size;		//Bytes per block (rounded up to a multiple of 4)
+	uint32_t free_count;		//Blocks currently available
+} xBlockPool;
+
+//STRUCT: xEventGroup
+//DESCRIPTION: Group of event flag bits (EVENT_BITS_MASK) tasks can wait on, for any or all bits
+typedef struct {
+	volatile uint32_t bits;		//Event flags currently set
+	xWaitList waiters;			//Tasks blocked until their bits are set, in precedence order
+} xEventGroup;
+
+//STRUCT: xTimer
+//DESCRIPTION: Software timer whose callback runs within the timer service task, either once
+//(one-shot) or every period ticks (auto-reload)
+typedef struct xTimer {
+	struct xTimer *next;		//Next timer within the same timing wheel slot or list
+	struct xTimer *prev;		//Previous timer within the same timing wheel slot or list
+	struct xTimer **list;		//Wheel slot (or expired list) holding the timer, 0 == stopped
+	uint32_t expiry;			//SystemTick at which the timer expires
+	uint32_t period;			//Ticks from start (or previous expiry) to expiry
+	bool auto_reload;			//Restart after every expiry rather than once
+	void (*callback)(struct xTimer *timer); //Called by the timer service task on expiry
+	void *context;				//User data for the callback
+} xTimer;
+
+//STRUCT: xLatencyHistogram
+//DESCRIPTION: log2 histogram of wake-to-dispatch latencies in cycles (see LATENCY_BUCKETS)
+typedef struct {
+	uint32_t bucket[LATENCY_BUCKETS];	//Latencies recorded per power of 2
+	uint32_t samples;			//Latencies recorded in total
+	uint32_t max;				//Longest latency recorded
+} xLatencyHistogram;
+
 //STRUCT: xMailbox
-//DESCRIPTION:
+//DESCRIPTION: Queue of up to MAILBOX_DEPTH ints
 typedef struct {
-	xSemaphore sem_Space;		//Indicates Mailbox Status: false == emtpy, true == full
-	xSemaphore sem_Data;		//Indicates Mailbox holds Data: false == empty, true == full
-	int the_data;				//Data Held by Mailbox
+	xQueue queue;				//Queue carrying the mailbox data
+	int the_data[MAILBOX_DEPTH];//Data Held by Mailbox
 } xMailbox;
 
 //------------------------------------------------------------------------------------------------//
 // -- 								GLOBAL VARIABLES										   -- //
 //------------------------------------------------------------------------------------------------//
-TaskControlBlock TCB[NUM_TASKS]; 		//Array which holds (NUM_TASKS) of Task Control Blocks(TCB)
-volatile TaskControlBlock* CurrentTask; //Points to the current task executing
-uint32_t SystemTick; 					//System Tick incremented as defined by end user
-int idle_count; 						//Count for aperiodic/sporadic tasks
+extern TaskControlBlock TCB[NUM_TASKS]; 		//Array which holds (NUM_TASKS) of Task Control Blocks(TCB)
+extern volatile TaskControlBlock* CurrentTask; //Points to the current task executing
+extern uint32_t SystemTick; 					//System Tick incremented as defined by end user
+extern int idle_count; 						//Count for aperiodic/sporadic tasks
 
 //------------------------------------------------------------------------------------------------//
 // -- 								FUNCTION PROTOTYPES 									   -- //
@@ -73,13 +229,76 @@ int idle_count; 						//Count for aperiodic/sporadic tasks
 
 //Initialize Binary Semaphore Array to untaken and assign an index to each semaphore
 void initSemaphoreBinary(xSemaphore* SemaphoreList, int initialSize);
+//Initialize Signalling Semaphore Array to taken, without priority inheritance (ISR to task signals)
+void initSemaphoreSignal(xSemaphore* SemaphoreList, int initialSize);
 void xSemaphoreTake(xSemaphore* Semaphore);			 //Take Semaphore if Available
 void xSemaphoreGive(xSemaphore* Semaphore);			 //Check Algorithm and Give Semaphore
+void xSemaphoreGiveFromISR(xSemaphore* Semaphore);	 //Give Semaphore from an ISR
+int xSemaphoreTakeTimeout(xSemaphore* Semaphore, uint32_t ticks); //Take, RTOS_TIMEOUT after ticks
+//Initialize Counting Semaphore with initial units available out of max_count
+void initSemaphoreCounting(xSemaphoreCounting* Semaphore, uint32_t initial, uint32_t max_count);
+void xSemaphoreTakeCounting(xSemaphoreCounting* Semaphore); //Take a unit, block while none are left
+int xSemaphoreGiveCounting(xSemaphoreCounting* Semaphore);	 //Give a unit back, RTOS_FULL at max_count
+int xSemaphoreGiveCountingFromISR(xSemaphoreCounting* Semaphore); //Give a unit back from an ISR
+int xSemaphoreTakeCountingTimeout(xSemaphoreCounting* Semaphore, uint32_t ticks); //Take, RTOS_TIMEOUT after ticks
+void initQueue(xQueue* queue, void* storage, uint32_t item_size, uint32_t depth); //Initialize Queue
+void xQueueSend(xQueue* queue, const void* item);	 //Copy item into Queue, block while full
+void xQueueReceive(xQueue* queue, void* item);		 //Copy oldest item out of Queue, block while empty
+int xQueueSendTimeout(xQueue* queue, const void* item, uint32_t ticks); //Send, RTOS_TIMEOUT after ticks
+int xQueueReceiveTimeout(xQueue* queue, void* item, uint32_t ticks);	 //Receive, RTOS_TIMEOUT after ticks
+int xQueueSendFromISR(xQueue* queue, const void* item);	 //Send from an ISR, RTOS_FULL if full
+int xQueueReceiveFromISR(xQueue* queue, void* item);	 //Receive from an ISR, RTOS_TIMEOUT if empty
+void xQueueSendBlock(xQueue* queue, void* block);	 //Send a block's address through a pointer Queue
+void* xQueueReceiveBlock(xQueue* queue);			 //Receive ownership of a block from a pointer Queue
+//Initialize Block Pool of num_blocks blocks of block_size bytes over storage
+void initBlockPool(xBlockPool* pool, void* storage, uint32_t block_size, uint32_t num_blocks);
+void* pvBlockAlloc(xBlockPool* pool);				 //Allocate a block (task or ISR), 0 if none are free
+void vBlockFree(xBlockPool* pool, void* block);		 //Return a block to its pool (task or ISR)
+void initEventGroup(xEventGroup* group);				 //Initialize Event Group with all bits clear
+//Wait for any (or all) bits, optionally clearing them, returns the group's bits
+uint32_t xEventGroupWaitBits(xEventGroup* group, uint32_t bits, bool clear_on_exit, bool wait_all,
+							 uint32_t ticks);
+uint32_t xEventGroupSetBits(xEventGroup* group, uint32_t bits);   //Set bits, wake satisfied tasks
+uint32_t xEventGroupClearBits(xEventGroup* group, uint32_t bits); //Clear bits
+uint32_t xEventGroupSetBitsFromISR(xEventGroup* group, uint32_t bits); //Set bits from an ISR
 void readFromBox(xMailbox *box, int* x);			 //Read Data From Mailbox
 void writeToBox(xMailbox *box, int* x);				 //Write data into mailbox
 void initMailbox(xMailbox *box, int index);			 //Initalize Mailbox Semaphores and Parameters
+int readFromBoxTimeout(xMailbox *box, int* x, uint32_t ticks); //Read, RTOS_TIMEOUT after ticks
+int writeToBoxTimeout(xMailbox *box, int* x, uint32_t ticks);	//Write, RTOS_TIMEOUT after ticks
+int readFromBoxFromISR(xMailbox *box, int* x);		 //Read from an ISR, RTOS_TIMEOUT if empty
+int writeToBoxFromISR(xMailbox *box, int* x);		 //Write from an ISR, RTOS_FULL if full
+int xTaskNotify(int task, uint32_t value, int action);	 //Update a task's notification value, wake it
+void xTaskNotifyGive(int task);						 //Increment a task's notification value, wake it
+int xTaskNotifyFromISR(int task, uint32_t value, int action); //Update a notification value from an ISR
+void vTaskNotifyGiveFromISR(int task);				 //Increment a task's notification value from an ISR
+//Wait for a notification, returns RTOS_OK or RTOS_TIMEOUT and the notification value
+int xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, uint32_t ticks);
+uint32_t ulTaskNotifyTake(bool clear_on_exit, uint32_t ticks); //Wait for a non-zero value, consume it
+//Create the timer service task that runs every timer callback
+void initTimerService(int task, void *stack, uint32_t stack_words, int32_t priority);
+//Initialize a stopped timer expiring period ticks after it is started
+void initTimer(xTimer* timer, uint32_t period, bool auto_reload, void (*callback)(xTimer*), void* context);
+void xTimerStart(xTimer* timer);					 //(Re)start a timer, expires period ticks from now
+void xTimerStop(xTimer* timer);						 //Stop a timer, its callback will not run
+uint32_t uxTaskGetBoostTicks(int task);				 //SystemTicks a task has spent priority boosted
+void vRunTimeWindowStart(void);						 //Start a new CPU utilization measurement window
+uint32_t ulTaskGetRunTime(int task);				 //Total DWT cycles a task has run (wraps at 2^32)
+uint32_t uxTaskGetUtilization(int task, uint32_t* switches); //Window CPU use (0.01%) and switches
+uint32_t uxTaskGetStackHighWaterMark(int task);		 //Fewest stack words a task has left unused
+void vTaskStackScan(void);							 //Update one task's high-water mark (idle loop)
+//Copy (and optionally clear) one LATENCY_ histogram
+void vLatencyHistogramRead(int kind, xLatencyHistogram* histogram, bool reset);
 TaskControlBlock* scheduler(void); 					 //Real-Time Task Scheduler
+void Yield(void);									 //Context switch to the highest precedence ready task
+int TickIncrement(void);							 //Advance SystemTick, 1 if a released task preempts
+int initSystemTick(uint32_t cycles_per_tick);		 //Start SysTick, returns non-zero on failure
 void vTaskDelayUntil(int* release_time, int period); //Set release time of task
+void vTaskSetDeadlinePolicy(int task, int32_t policy); //DEADLINE_CATCH_UP or DEADLINE_SKIP
+uint32_t uxTaskGetDeadlineMisses(int task, uint32_t* skipped); //Late jobs and skipped releases
+//Call hook(task, missed releases) whenever vTaskDelayUntil finds a job overran, 0 == no hook
+void vSetDeadlineMissHook(void (*hook)(int task, uint32_t missed));
+void vTaskYield(void);								 //Let the next ready task of equal priority run
 //Create Real-Time Task: allocate memory, define parameters.
 void CreateTask(int task, void (*funct)(), void *stack, uint32_t stack_words, int32_t priority);
 
@@ -0,0 +1,114 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Trace Recorder
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* myTrace.c records kernel events into the TraceBuffer ring buffer, see myTrace.h for the record
+ * format. Recording an event is a handful of loads and stores with interrupts briefly masked, so
+ * the recorder can stay enabled in production builds.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include "port.h"
+#include "myRTOS.h"
+#include "myTrace.h"
+
+xTraceBuffer TraceBuffer; //Trace ring buffer
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTraceStart
+//*DESCRIPTION: Discards any recorded events and starts recording. The DWT cycle counter used for
+//*timestamps is started by initSystemTick.
+//*INPUTS: mode (TRACE_MODE_SNAPSHOT or TRACE_MODE_STREAM)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTraceStart(uint8_t mode)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	TraceBuffer.magic = TRACE_MAGIC;
+	TraceBuffer.version = TRACE_VERSION;
+	TraceBuffer.record_size = sizeof(xTraceRecord);
+	TraceBuffer.capacity = TRACE_BUFFER_RECORDS;
+	TraceBuffer.clock_hz = SystemCoreClock;
+	TraceBuffer.head = 0;
+	TraceBuffer.tail = 0;
+	TraceBuffer.dropped = 0;
+	TraceBuffer.mode = mode;
+	TraceBuffer.running = 1;
+	__set_PRIMASK(primask);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTraceStop
+//*DESCRIPTION: Stops recording so the buffer can be dumped as a consistent snapshot
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTraceStop(void)
+{
+	TraceBuffer.running = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: vTraceRecord
+//*DESCRIPTION: Appends one event to the trace buffer. In snapshot mode the oldest record is
+//*overwritten once the buffer is full, in stream mode the new record is dropped and counted.
+//*Restores the caller's interrupt mask, so it is safe from tasks, ISRs and the kernel alike.
+//*INPUTS: event (TRACE_EVT_ code), object (event argument, see myTrace.h)
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void vTraceRecord(uint8_t event, uint32_t object)
+{
+	if(!TraceBuffer.running)
+	{
+		return;
+	}
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t head = TraceBuffer.head;
+	if(TraceBuffer.mode == TRACE_MODE_STREAM && head - TraceBuffer.tail == TRACE_BUFFER_RECORDS)
+	{
+		TraceBuffer.dropped++; //reader has fallen behind
+	}
+	else
+	{
+		xTraceRecord* record = &TraceBuffer.records[head & (TRACE_BUFFER_RECORDS-1)];
+		record->timestamp = portCycleCount();
+		record->event = event;
+		record->task = (CurrentTask != 0) ? (uint8_t)CurrentTask->task : 0;
+		record->object = (uint16_t)object;
+		TraceBuffer.head = head + 1;
+	}
+	__set_PRIMASK(primask);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: uxTraceRead
+//*DESCRIPTION: Stream mode. Copies out and releases the oldest unread records, e.g. from a low
+//*priority task forwarding them over a UART or SWO.
+//*INPUTS: Address to copy records to, most records to copy
+//*OUTPUTS: Number of records copied
+//------------------------------------------------------------------------------------------------//
+uint32_t uxTraceRead(xTraceRecord* records, uint32_t max)
+{
+	uint32_t count = 0;
+	while(count < max)
+	{
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		uint32_t tail = TraceBuffer.tail;
+		if(tail == TraceBuffer.head)
+		{
+			__set_PRIMASK(primask);
+			break; //nothing left to read
+		}
+		records[count++] = TraceBuffer.records[tail & (TRACE_BUFFER_RECORDS-1)];
+		TraceBuffer.tail = tail + 1;
+		__set_PRIMASK(primask);
+	}
+	return count;
+}
@@ -0,0 +1,113 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Trace Recorder
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* myTrace.h contains the interface of the myRTOS binary trace recorder. The kernel records
+*  context switches, tick interrupts, semaphore and mailbox operations, and user code records
+*  ISR entry/exit, into a ring buffer of 8 byte records in RAM. With TRACE_ENABLE set to 0 every
+*  TRACE_ macro compiles to nothing.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef MYTRACE_H_
+#define MYTRACE_H_
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1 //1 == kernel events are recorded, 0 == recorder compiled out
+#endif
+#define TRACE_BUFFER_RECORDS 512 //Records held by the ring buffer (power of 2, 8 bytes each)
+
+//Recording Modes
+#define TRACE_MODE_SNAPSHOT 0 //Overwrite the oldest records, the buffer holds the latest history
+#define TRACE_MODE_STREAM 1	  //Keep the oldest records until uxTraceRead drains them, count drops
+
+//TRACE FORMAT (version TRACE_VERSION, little endian)
+//The whole xTraceBuffer is dumped as is (e.g. by the debugger) or streamed record by record. The
+//buffer holds head records in total; record i (head-min(head,capacity) <= i < head) sits at
+//records[i % capacity]. Timestamps are DWT->CYCCNT at clock_hz and wrap at 2^32, so consecutive
+//records must lie less than 2^32 cycles apart (a TRACE_EVT_TICK is recorded on every SysTick).
+//Kernel objects are identified by TRACE_OBJECT, bits 2..17 of their address.
+//
+//  event               task            object
+//  TRACE_EVT_SWITCH    outgoing task   incoming task
+//  TRACE_EVT_TICK      running task    low 16 bits of SystemTick
+//  TRACE_EVT_SEM_TAKE  taking task     semaphore (taken, possibly after blocking)
+//  TRACE_EVT_SEM_GIVE  giving task     semaphore
+//  TRACE_EVT_SEM_BLOCK blocked task    semaphore (task blocks until TAKE or its timeout)
+//  TRACE_EVT_MBOX_WRITE writing task   mailbox (one value written)
+//  TRACE_EVT_MBOX_READ reading task    mailbox (oldest value read, FIFO order)
+//  TRACE_EVT_ISR_ENTER interrupted task exception number (IPSR)
+//  TRACE_EVT_ISR_EXIT  interrupted task exception number (IPSR)
+#define TRACE_MAGIC 0x5254526Du //"mRTR"
+#define TRACE_VERSION 1
+#define TRACE_EVT_SWITCH 1
+#define TRACE_EVT_TICK 2
+#define TRACE_EVT_SEM_TAKE 3
+#define TRACE_EVT_SEM_GIVE 4
+#define TRACE_EVT_SEM_BLOCK 5
+#define TRACE_EVT_MBOX_WRITE 6
+#define TRACE_EVT_MBOX_READ 7
+#define TRACE_EVT_ISR_ENTER 8
+#define TRACE_EVT_ISR_EXIT 9
+
+//------------------------------------------------------------------------------------------------//
+// -- 									STRUCTURES											   -- //
+//------------------------------------------------------------------------------------------------//
+//STRUCT: xTraceRecord
+//DESCRIPTION: One 8 byte trace event
+typedef struct {
+	uint32_t timestamp;			//DWT->CYCCNT when the event was recorded
+	uint8_t event;				//TRACE_EVT_ code
+	uint8_t task;				//Task running (or interrupted) when the event was recorded
+	uint16_t object;			//Event argument, see TRACE FORMAT
+} xTraceRecord;
+
+//STRUCT: xTraceBuffer
+//DESCRIPTION: Trace ring buffer, laid out to be dumped from RAM and decoded on the host
+typedef struct {
+	uint32_t magic;				//TRACE_MAGIC
+	uint16_t version;			//TRACE_VERSION
+	uint16_t record_size;		//sizeof(xTraceRecord)
+	uint32_t capacity;			//TRACE_BUFFER_RECORDS
+	uint32_t clock_hz;			//DWT timestamp rate (core clock)
+	volatile uint32_t head;		//Records written since vTraceStart
+	volatile uint32_t tail;		//Records drained by uxTraceRead (stream mode)
+	volatile uint32_t dropped;	//Records lost while the buffer was full (stream mode)
+	uint8_t mode;				//TRACE_MODE_SNAPSHOT or TRACE_MODE_STREAM
+	volatile uint8_t running;	//Events are recorded: 0 == false, 1 == true
+	uint16_t reserved;
+	xTraceRecord records[TRACE_BUFFER_RECORDS];
+} xTraceBuffer;
+
+//------------------------------------------------------------------------------------------------//
+// -- 								GLOBAL VARIABLES										   -- //
+//------------------------------------------------------------------------------------------------//
+extern xTraceBuffer TraceBuffer;		//Trace ring buffer, dump this symbol for the host tools
+
+//------------------------------------------------------------------------------------------------//
+// -- 								FUNCTION PROTOTYPES 									   -- //
+//------------------------------------------------------------------------------------------------//
+//*NOTE: See Function Definitions in myTrace.c for Complete Description
+void vTraceStart(uint8_t mode);						 //Clear the buffer and start recording
+void vTraceStop(void);								 //Stop recording, freezing a snapshot
+void vTraceRecord(uint8_t event, uint32_t object);	 //Record one event (task or ISR)
+uint32_t uxTraceRead(xTraceRecord* records, uint32_t max); //Drain the oldest records (stream mode)
+
+#define TRACE_OBJECT(ptr) ((uint32_t)((uintptr_t)(ptr) >> 2) & 0xFFFF) //Trace identifier of a kernel object
+
+#if TRACE_ENABLE
+#define TRACE_EVENT(event, object) vTraceRecord((event), (uint32_t)(object))
+#define TRACE_ISR_ENTER() vTraceRecord(TRACE_EVT_ISR_ENTER, __get_IPSR()) //First line of an ISR
+#define TRACE_ISR_EXIT() vTraceRecord(TRACE_EVT_ISR_EXIT, __get_IPSR())	 //Last line of an ISR
+#else
+#define TRACE_EVENT(event, object)
+#define TRACE_ISR_ENTER()
+#define TRACE_ISR_EXIT()
+#endif
+
+#endif /* MYTRACE_H_ */
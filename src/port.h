@@ -0,0 +1,24 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Port Selection
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* port.h selects the port myRTOS.c is compiled against. A port supplies the CMSIS intrinsics the
+*  kernel uses (__disable_irq, __get_PRIMASK, __LDREXW, __CLZ, ...) and the portInitStack,
+*  portInitTick, portPendSwitch and portCycleCount hooks, plus the Yield and context switch
+*  handlers. The Cortex-M3 port is the default, MYRTOS_PORT_POSIX builds the Linux host port.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef PORT_H_
+#define PORT_H_
+
+#if defined(MYRTOS_PORT_POSIX)
+#include "port_posix.h"	//port/posix, tasks as ucontexts, SIGALRM as SysTick
+#else
+#include "port_cm3.h"	//Cortex-M3, SysTick and PendSV (context.s)
+#endif
+
+#endif /* PORT_H_ */
@@ -0,0 +1,118 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Cortex-M3 Port
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* port_cm3.h holds the Cortex-M3 specific parts of myRTOS.c: building the initial exception frame
+*  of a task, starting SysTick, PendSV and the DWT cycle counter, and pending a context switch.
+*  The context switch itself is done by the SysTick and PendSV handlers in context.s. The CMSIS
+*  intrinsics come from the device header, CM3_DEVICE_HEADER (em_device.h by default). Cores
+*  without a DWT cycle counter (QEMU) build with CM3_NO_DWT 1 and TICKLESS 0, counting cycles
+*  from SystemTick and the SysTick counter instead.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef PORT_CM3_H_
+#define PORT_CM3_H_
+
+#ifndef CM3_DEVICE_HEADER
+#define CM3_DEVICE_HEADER "em_device.h" //EFM32GG, any CMSIS Cortex-M3 device header will do
+#endif
+#include CM3_DEVICE_HEADER
+
+#ifndef CM3_NO_DWT
+#define CM3_NO_DWT 0 //1 == the core has no DWT cycle counter, count SysTick cycles
+#endif
+
+#ifndef CM3_SWITCH_IN_SYSTICK
+#define CM3_SWITCH_IN_SYSTICK 0 //1 == context.s switches inside SysTick on every tick (benchmarks only)
+#endif
+
+extern uint32_t SystemTick; //System Tick, see myRTOS.h
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portInitStack
+//*DESCRIPTION: Builds the frame PendSV_Handler pops when the task is first switched in: the
+//*hardware exception frame returning to funct in Thumb state, then r4-r11.
+//*INPUTS: task (identifier), stack (task stack memory), stack_words (size of stack memory),
+//*funct (task handler)
+//*OUTPUTS: Initial stack pointer of the task
+//------------------------------------------------------------------------------------------------//
+static inline uint32_t* portInitStack(int task, void *stack, uint32_t stack_words, void (*funct)())
+{
+	(void)task;
+	uint32_t *ptr = (uint32_t *)stack + (stack_words-1); // a pointer to the last byte of stack
+	*ptr-- = 0x01000000; 								 // xPSR, Thumb state only (program status register), decrement the stack pointer
+	*ptr-- = (uint32_t)funct; 							 //decrement it again and have it point to our function
+	for (int i=0; i<6; ++i)	*ptr-- = 0; 				 // lr, r12, r3, r2, r1, r0 , place 0's in the stack for the next 6 positions
+	*ptr = -7; 											 // exception link register
+	for (int i=0; i<8; ++i)	*--ptr = 0; 				 // r11, r10, r9, r8, r7, r6, r5, r4 // place some more zeros
+	return ptr;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portInitTick
+//*DESCRIPTION: Starts SysTick with a period of cycles_per_tick, drops PendSV to the lowest
+//*priority so every context switch runs last, and starts the DWT cycle counter context.s
+//*timestamps every switch with
+//*INPUTS: Core clock cycles per SystemTick
+//*OUTPUTS: 0 on success, non-zero if SysTick cannot count cycles_per_tick
+//------------------------------------------------------------------------------------------------//
+static inline int portInitTick(uint32_t cycles_per_tick)
+{
+	if(SysTick_Config(cycles_per_tick))
+	{
+		return 1;
+	}
+	NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+#if !CM3_NO_DWT
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portPendSwitch
+//*DESCRIPTION: Pends PendSV, which switches context once every active interrupt has returned
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static inline void portPendSwitch(void)
+{
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: portCycleCount
+//*DESCRIPTION: Free running core clock cycle counter used for runtime accounting and trace
+//*timestamps, context.s reads the same DWT->CYCCNT register directly. With CM3_NO_DWT the cycles
+//*of every completed tick are added to those elapsed within the running SysTick period, which
+//*context.s reads through cm3CycleCount.
+//*INPUTS: N/A
+//*OUTPUTS: DWT->CYCCNT (wraps at 2^32)
+//------------------------------------------------------------------------------------------------//
+static inline uint32_t portCycleCount(void)
+{
+#if CM3_NO_DWT
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t reload = SysTick->LOAD + 1;
+	uint32_t count = SysTick->VAL;
+	uint32_t ticks = SystemTick;
+	if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) //period ended, interrupt not yet serviced
+	{
+		count = SysTick->VAL; //counter reloaded, read it again
+		ticks++;
+	}
+	__set_PRIMASK(primask);
+	return ticks*reload + (reload - 1 - count);
+#else
+	return DWT->CYCCNT;
+#endif
+}
+
+#endif /* PORT_CM3_H_ */
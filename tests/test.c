@@ -0,0 +1,196 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Host Tests
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* test.c implements the host test harness declared in test.h: kernel start-up with a software
+*  stepped tick, an ordered log of values recorded by the tasks, and a runner forking one child
+*  process per test case.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "test.h"
+
+uint32_t TestStacks[NUM_TASKS][TEST_STACK_WORDS]; //Stack of every task
+int TestLog[TEST_LOG_SIZE];		//Values recorded by the test case, in order
+int TestLogLength;				//Values recorded so far
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testCheck
+//*DESCRIPTION: Ends the test case as failed, reporting the failed expression, unless ok is true.
+//*Usable from tasks and from the idle loop.
+//*INPUTS: ok (checked condition), expr (its source text), file and line of the check
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void testCheck(int ok, const char* expr, const char* file, int line)
+{
+	if(!ok)
+	{
+		__disable_irq(); //no task switches while stdio runs
+		fprintf(stderr, "  %s:%d: CHECK(%s) failed at tick %u\n", file, line, expr,
+				(unsigned)SystemTick);
+		_exit(1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testKernelStart
+//*DESCRIPTION: Initializes the kernel as main() does on the board, then stops the interval timer
+//*so SystemTick only advances through testTicks
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void testKernelStart(void)
+{
+	CurrentTask = TCB;
+	SystemTick = 0;
+	idle_count = 0;
+	TestLogLength = 0;
+	CHECK(initSystemTick(SystemCoreClock/1000) == 0);
+	portStopTick();
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testCreateTask
+//*DESCRIPTION: Creates a task on its stack within TestStacks. A task created ahead of the idle
+//*loop runs before this returns, until it blocks or delays.
+//*INPUTS: task (identifier), task handler, priority of the task
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void testCreateTask(int task, void (*funct)(), int32_t priority)
+{
+	CreateTask(task, funct, TestStacks[task], TEST_STACK_WORDS, priority);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testTicks
+//*DESCRIPTION: Steps SystemTick the given number of times from the idle loop. Every task released
+//*by a tick runs until it blocks or delays again before the next tick is raised.
+//*INPUTS: Number of ticks
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void testTicks(uint32_t ticks)
+{
+	while(ticks-- > 0)
+	{
+		portStepTick();
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testPark
+//*DESCRIPTION: Blocks the calling task for good, in place of returning from its handler
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void testPark(void)
+{
+	while(1)
+	{
+		ulTaskNotifyTake(true, WAIT_FOREVER); //nobody notifies a parked task
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testRecord
+//*DESCRIPTION: Appends a value (e.g. task identifier and job number) to TestLog, interrupts masked
+//*INPUTS: value
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+void testRecord(int value)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	CHECK(TestLogLength < TEST_LOG_SIZE);
+	TestLog[TestLogLength++] = value;
+	__set_PRIMASK(primask);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testLogEquals
+//*DESCRIPTION: Compares TestLog with the expected values, printing both when they differ
+//*INPUTS: Expected values and their number
+//*OUTPUTS: 1 if TestLog holds exactly the expected values, else 0
+//------------------------------------------------------------------------------------------------//
+int testLogEquals(const int* expected, int length)
+{
+	int equal = (TestLogLength == length);
+	for(int i = 0; equal && i < length; i++)
+	{
+		equal = (TestLog[i] == expected[i]);
+	}
+	if(!equal)
+	{
+		__disable_irq();
+		fprintf(stderr, "  expected:");
+		for(int i = 0; i < length; i++)
+		{
+			fprintf(stderr, " %d", expected[i]);
+		}
+		fprintf(stderr, "\n  recorded:");
+		for(int i = 0; i < TestLogLength; i++)
+		{
+			fprintf(stderr, " %d", TestLog[i]);
+		}
+		fprintf(stderr, "\n");
+	}
+	return equal;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: testRun
+//*DESCRIPTION: Runs one test case in a child process, which starts from the untouched kernel state
+//*of the parent. The case fails if it fails a CHECK, crashes or runs longer than TEST_TIMEOUT_MS.
+//*INPUTS: name of the test case, test body (runs as the idle loop)
+//*OUTPUTS: 0 if the test case passed, 1 if it failed
+//------------------------------------------------------------------------------------------------//
+int testRun(const char* name, void (*test)(void))
+{
+	fflush(stdout);
+	pid_t child = fork();
+	if(child == 0)
+	{
+		test();
+		_exit(0);
+	}
+	int status = 0;
+	int waited = 0;
+	while(waitpid(child, &status, WNOHANG) == 0)
+	{
+		if(waited++ == TEST_TIMEOUT_MS)
+		{
+			kill(child, SIGKILL);
+			waitpid(child, &status, 0);
+			printf("FAIL %s (timed out)\n", name);
+			return 1;
+		}
+		struct timespec millisecond = {0, 1000000};
+		nanosleep(&millisecond, 0);
+	}
+	if(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+	{
+		printf("PASS %s\n", name);
+		return 0;
+	}
+	if(WIFSIGNALED(status))
+	{
+		printf("FAIL %s (signal %d)\n", name, WTERMSIG(status));
+	}
+	else
+	{
+		printf("FAIL %s\n", name);
+	}
+	return 1;
+}
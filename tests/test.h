@@ -0,0 +1,44 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Host Tests
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* test.h holds the small harness of the myRTOS host tests, which run the kernel on the POSIX
+*  port. Every test case runs in a child process of its own, so each one starts from a freshly
+*  initialized kernel. The interval timer is stopped and the test body, running as the idle loop,
+*  steps SystemTick with testTicks, so every release happens at a known point of the test.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdint.h>
+#include "myRTOS.h"
+
+#define TEST_STACK_WORDS 16384 //host frames (and signal delivery) need far more stack than the board
+#define TEST_LOG_SIZE 256	   //Values testRecord keeps
+#define TEST_TIMEOUT_MS 10000  //Wall clock time a test case may take before it counts as hung
+
+#define CHECK(cond) testCheck((cond), #cond, __FILE__, __LINE__) //Fail the test case unless cond
+
+extern uint32_t TestStacks[NUM_TASKS][TEST_STACK_WORDS]; //Stack of every task
+extern int TestLog[TEST_LOG_SIZE];	//Values recorded by the test case, in order
+extern int TestLogLength;			//Values recorded so far
+
+//------------------------------------------------------------------------------------------------//
+// -- 								FUNCTION PROTOTYPES 									   -- //
+//------------------------------------------------------------------------------------------------//
+//*NOTE: See Function Definitions in test.c for Complete Description
+void testCheck(int ok, const char* expr, const char* file, int line); //Fail the test case unless ok
+void testKernelStart(void);						//Initialize the kernel with the tick stopped
+void testCreateTask(int task, void (*funct)(), int32_t priority); //CreateTask on TestStacks[task]
+void testTicks(uint32_t ticks);					//Step SystemTick from the idle loop
+void testPark(void);							//Block the calling task for good
+void testRecord(int value);						//Append a value to TestLog (tasks or idle loop)
+int testLogEquals(const int* expected, int length); //TestLog holds exactly the expected values
+int testRun(const char* name, void (*test)(void)); //Run a test case in a child, 0 if it passed
+
+#endif /* TEST_H_ */
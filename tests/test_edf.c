@@ -0,0 +1,188 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - EDF Host Tests
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* test_edf.c tests the Earliest-Deadline-First build (SCHEDULER SCHED_EDF) on the POSIX port by
+*  running periodic task sets, feasible and overloaded, and comparing the schedule with the one
+*  EDF prescribes. Time is divided into tick slots: a job of cost C claims C slots, one per tick,
+*  and completes within its last slot, where it calls vTaskDelayUntil. TestLog records the owner
+*  of every slot (0 == idle), Jobs the slot each job completed in. The expected schedules follow
+*  the kernel's rules: earliest absolute deadline first (release + period), equal deadlines by
+*  priority, first release at tick 1.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#include "port.h"
+#include "myRTOS.h"
+#include "test.h"
+
+#if SCHEDULER != SCHED_EDF
+#error "test_edf.c tests the EDF build, compile with SCHEDULER=SCHED_EDF"
+#endif
+
+#define MAX_JOBS 64
+
+static int Cost[NUM_TASKS];		//slots per job of every task
+static int Period[NUM_TASKS];	//release period of every task
+static uint32_t Horizon;		//slots the schedule is recorded for
+static int Jobs[MAX_JOBS];		//1000 * task + slot of every completed job, in order
+static int JobCount;
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: slotClaim
+//*DESCRIPTION: Runs the calling task for one tick slot: steps the tick past any slot already
+//*claimed (ending the slot a job completed in), then records the task as the owner of the
+//*current slot. A higher precedence job released by the tick runs first. Tasks park once the
+//*horizon is reached.
+//*INPUTS: task identifier
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void slotClaim(int task)
+{
+	while(TestLogLength > (int)SystemTick)
+	{
+		portStepTick();
+	}
+	if(SystemTick >= Horizon)
+	{
+		testPark();
+	}
+	testRecord(task);
+}
+
+//Periodic task of Cost[task] slots every Period[task] ticks
+static void periodicJob(void)
+{
+	int task = CurrentTask->task;
+	int release = 1;
+	while(1)
+	{
+		vTaskDelayUntil(&release, Period[task]);
+		for(int slot = 0; slot < Cost[task]; slot++)
+		{
+			slotClaim(task);
+		}
+		__disable_irq();
+		CHECK(JobCount < MAX_JOBS);
+		Jobs[JobCount++] = task * 1000 + (int)SystemTick;
+		__enable_irq();
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: runTaskSet
+//*DESCRIPTION: Creates tasks 1..tasks with the given costs and periods (priority == identifier),
+//*all first released at tick 1, and records the schedule of the first horizon slots
+//*INPUTS: number of tasks, cost and period of each (index 0 is task 1), deadline policy, horizon
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void runTaskSet(int tasks, const int* cost, const int* period, int32_t policy, uint32_t horizon)
+{
+	testKernelStart();
+	Horizon = horizon;
+	JobCount = 0;
+	for(int task = 1; task <= tasks; task++)
+	{
+		Cost[task] = cost[task-1];
+		Period[task] = period[task-1];
+		testCreateTask(task, periodicJob, task); //delays until tick 1
+		vTaskSetDeadlinePolicy(task, policy);
+	}
+	while(SystemTick < Horizon)
+	{
+		if(TestLogLength == (int)SystemTick)
+		{
+			testRecord(0); //idle slot
+		}
+		portStepTick();
+	}
+}
+
+//Checks the recorded job completions
+static int jobsEqual(const int* expected, int length)
+{
+	int equal = (JobCount == length);
+	for(int i = 0; equal && i < length; i++)
+	{
+		equal = (Jobs[i] == expected[i]);
+	}
+	return equal;
+}
+
+//U = 2/4 + 3/6 = 1, EDF meets every deadline
+static void testFeasibleFullUtilization(void)
+{
+	static const int cost[] = {2, 3};
+	static const int period[] = {4, 6};
+	static const int slots[] = {0, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 2};
+	static const int jobs[] = {1002, 2005, 1007, 1010, 2012, 1014, 2017, 1019, 1022};
+	runTaskSet(2, cost, period, DEADLINE_CATCH_UP, 24);
+	CHECK(testLogEquals(slots, 24));
+	CHECK(jobsEqual(jobs, 9));
+	CHECK(uxTaskGetDeadlineMisses(1, 0) == 0);
+	CHECK(uxTaskGetDeadlineMisses(2, 0) == 0);
+}
+
+//U = 1/3 + 2/5 + 3/7 = 1.16, late jobs run back to back in deadline order
+static void testOverloadCatchUp(void)
+{
+	static const int cost[] = {1, 2, 3};
+	static const int period[] = {3, 5, 7};
+	static const int slots[] = {0, 1, 2, 2, 1, 3, 3, 3, 1, 2, 2, 1, 3, 3, 3, 1, 2, 2, 1, 2, 2, 1, 3,
+								3, 3, 1, 2, 2, 1, 3, 3, 3, 1, 2, 2, 1};
+	static const int jobs[] = {1001, 2003, 1004, 3007, 1008, 2010, 1011, 3014, 1015, 2017, 1018,
+							   2020, 1021, 3024, 1025, 2027, 1028, 3031, 1032, 2034, 1035};
+	runTaskSet(3, cost, period, DEADLINE_CATCH_UP, 36);
+	CHECK(testLogEquals(slots, 36));
+	CHECK(jobsEqual(jobs, 21));
+	CHECK(uxTaskGetDeadlineMisses(1, 0) == 4);
+	CHECK(uxTaskGetDeadlineMisses(2, 0) == 3);
+	CHECK(uxTaskGetDeadlineMisses(3, 0) == 2);
+}
+
+//U = 3/4 + 3/5 = 1.35, catching up delays task 1 until it runs three jobs back to back
+static void testHeavyOverloadCatchUp(void)
+{
+	static const int cost[] = {3, 3};
+	static const int period[] = {4, 5};
+	static const int slots[] = {0, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1,
+								1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2};
+	static const int jobs[] = {1003, 2006, 1009, 2012, 1015, 2018, 1021, 1024, 2027, 1030, 2033,
+							   1036, 2039};
+	uint32_t skipped;
+	runTaskSet(2, cost, period, DEADLINE_CATCH_UP, 40);
+	CHECK(testLogEquals(slots, 40));
+	CHECK(jobsEqual(jobs, 13));
+	CHECK(uxTaskGetDeadlineMisses(1, &skipped) == 6 && skipped == 0);
+	CHECK(uxTaskGetDeadlineMisses(2, &skipped) == 6 && skipped == 0);
+}
+
+//Same task set, DEADLINE_SKIP drops the releases whose deadline passed and the tasks alternate
+static void testHeavyOverloadSkip(void)
+{
+	static const int cost[] = {3, 3};
+	static const int period[] = {4, 5};
+	static const int slots[] = {0, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2,
+								2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1, 2, 2, 2, 1, 1, 1};
+	static const int jobs[] = {1003, 2006, 1009, 2012, 1015, 2018, 1021, 2024, 1027, 2030, 1033,
+							   2036, 1039};
+	uint32_t skipped;
+	runTaskSet(2, cost, period, DEADLINE_SKIP, 40);
+	CHECK(testLogEquals(slots, 40));
+	CHECK(jobsEqual(jobs, 13));
+	CHECK(uxTaskGetDeadlineMisses(1, &skipped) == 6 && skipped == 2);
+	CHECK(uxTaskGetDeadlineMisses(2, &skipped) == 6 && skipped == 1);
+}
+
+int main(void)
+{
+	int failures = 0;
+	failures += testRun("edf: feasible set at full utilization", testFeasibleFullUtilization);
+	failures += testRun("edf: overload schedule, catch-up", testOverloadCatchUp);
+	failures += testRun("edf: heavy overload schedule, catch-up", testHeavyOverloadCatchUp);
+	failures += testRun("edf: heavy overload schedule, skip", testHeavyOverloadSkip);
+	return failures != 0;
+}
@@ -0,0 +1,370 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Kernel Host Tests
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* test_kernel.c tests the fixed priority kernel on the POSIX port: priority inheritance and its
+*  boost accounting, signalling semaphores, releases from the delayed list (delta queue), also
+*  across the wrap of SystemTick, and software timers spread over and beyond the timing wheel.
+*  Each test case function is the idle loop of a fresh kernel, see test.h.
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#include "port.h"
+#include "myRTOS.h"
+#include "test.h"
+
+static xSemaphore Semaphores[1];
+static xMailbox Box;
+
+//------------------------------------------------------------------------------------------------//
+// -- 								PRIORITY INHERITANCE										   -- //
+//------------------------------------------------------------------------------------------------//
+//Owner of Semaphores[0] which then blocks on a mailbox, an object without priority inheritance
+static void mailboxOwner(void)
+{
+	int value;
+	xSemaphoreTake(&Semaphores[0]);
+	testRecord(1);
+	readFromBox(&Box, &value);
+	testRecord(2);
+	testRecord(100 + TCB[1].priority); //still boosted by the waiter
+	xSemaphoreGive(&Semaphores[0]);
+	testRecord(3);
+	testPark();
+}
+
+static void mailboxWaiter(void)
+{
+	xSemaphoreTake(&Semaphores[0]); //owner is blocked on the mailbox, not on a semaphore
+	testRecord(10);
+	xSemaphoreGive(&Semaphores[0]);
+	testPark();
+}
+
+static void testInheritOwnerBlockedOnMailbox(void)
+{
+	static const int expected[] = {1, 2, 101, 10, 3};
+	testKernelStart();
+	initSemaphoreBinary(Semaphores, 1);
+	initMailbox(&Box, 0);
+	testCreateTask(1, mailboxOwner, 5);
+	testCreateTask(2, mailboxWaiter, 1);
+	CHECK(TCB[1].priority == 1); //owner inherits the waiter's priority while blocked elsewhere
+	int value = 7;
+	writeToBox(&Box, &value);
+	CHECK(TCB[1].priority == 5);
+	CHECK(testLogEquals(expected, 5));
+}
+
+//Periodic task never boosted, its period and deadline change on every vTaskDelayUntil
+static void periodicTask(void)
+{
+	int release = 0;
+	while(1)
+	{
+		vTaskDelayUntil(&release, 5);
+		testRecord((int)SystemTick);
+	}
+}
+
+static void testBoostTicksUnboostedPeriodic(void)
+{
+	static const int expected[] = {0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50};
+	testKernelStart();
+	testCreateTask(1, periodicTask, 2);
+	testTicks(50);
+	CHECK(testLogEquals(expected, 11));
+	CHECK(uxTaskGetBoostTicks(1) == 0);
+}
+
+//Periodic owner holding Semaphores[0] until notified by the idle loop
+static void periodicOwner(void)
+{
+	int release = 0;
+	while(1)
+	{
+		vTaskDelayUntil(&release, 20);
+		xSemaphoreTake(&Semaphores[0]);
+		ulTaskNotifyTake(true, WAIT_FOREVER);
+		xSemaphoreGive(&Semaphores[0]);
+	}
+}
+
+static void semaphoreWaiter(void)
+{
+	xSemaphoreTake(&Semaphores[0]);
+	xSemaphoreGive(&Semaphores[0]);
+	testPark();
+}
+
+static void testBoostTicksCountsBoost(void)
+{
+	testKernelStart();
+	initSemaphoreBinary(Semaphores, 1);
+	testCreateTask(1, periodicOwner, 5);
+	testTicks(3);
+	testCreateTask(2, semaphoreWaiter, 1); //blocks, boosting the owner from tick 3
+	CHECK(TCB[1].priority == 1);
+	testTicks(7);
+	xTaskNotifyGive(1); //owner gives the semaphore at tick 10
+	CHECK(TCB[1].priority == 5);
+	testTicks(40); //two more unboosted jobs
+	CHECK(uxTaskGetBoostTicks(1) == 7);
+}
+
+//------------------------------------------------------------------------------------------------//
+// -- 								DELAYED LIST RELEASES									   -- //
+//------------------------------------------------------------------------------------------------//
+//Every task records 1000 * its identifier + SystemTick at the start of each job
+#define JOB(task) ((task) * 1000 + (int)SystemTick)
+
+//Periodic task: first release at tick 10, then every 10 ticks
+static void releaseAt10(void)
+{
+	int release = 10;
+	while(1)
+	{
+		vTaskDelayUntil(&release, 10);
+		testRecord(JOB(CurrentTask->task));
+	}
+}
+
+static void testSameTickReleasePriorityOrder(void)
+{
+	static const int expected[] = {1010, 2010, 3010, 1020, 2020, 3020};
+	testKernelStart();
+	testCreateTask(3, releaseAt10, 3); //delayed first, released last
+	testCreateTask(2, releaseAt10, 2);
+	testCreateTask(1, releaseAt10, 1);
+	testTicks(9);
+	CHECK(TestLogLength == 0);
+	testTicks(11);
+	CHECK(testLogEquals(expected, 6));
+}
+
+static void testSameTickReleaseEqualPriority(void)
+{
+	static const int expected[] = {2010, 1010, 3010, 2020, 1020, 3020};
+	testKernelStart();
+	testCreateTask(2, releaseAt10, 2); //equal priorities run in the order they were delayed
+	testCreateTask(1, releaseAt10, 2);
+	testCreateTask(3, releaseAt10, 2);
+	testTicks(20);
+	CHECK(testLogEquals(expected, 6));
+}
+
+//Released at tick 9, still running when tick 10 releases tasks 1 and 3
+static void runningAcrossTick10(void)
+{
+	int release = 9;
+	vTaskDelayUntil(&release, 10);
+	testRecord(JOB(2));
+	portStepTick(); //tick 10 arrives while this job runs
+	testRecord(JOB(2));
+	testPark();
+}
+
+static void testSameTickReleaseWhileRunning(void)
+{
+	static const int expected[] = {2009, 1010, 2010, 3010, 1020, 3020};
+	testKernelStart();
+	testCreateTask(1, releaseAt10, 1); //preempts the running task at tick 10
+	testCreateTask(2, runningAcrossTick10, 2);
+	testCreateTask(3, releaseAt10, 3); //waits until the running task is done
+	testTicks(9); //ticks 1..9, task 2 raises tick 10 itself
+	testTicks(10);
+	CHECK(SystemTick == 20);
+	CHECK(testLogEquals(expected, 6));
+}
+
+//Release tick of every releaseOnce task
+static const int ReleaseTick[NUM_TASKS] = {0, 12, 10, 11, 10, 12, 11};
+
+//Delays until its ReleaseTick, then records a single job
+static void releaseOnce(void)
+{
+	int release = ReleaseTick[CurrentTask->task];
+	vTaskDelayUntil(&release, 100);
+	testRecord(JOB(CurrentTask->task));
+	testPark();
+}
+
+static void testDeltaQueueMixedReleases(void)
+{
+	static const int expected[] = {2010, 4010, 3011, 6011, 1012, 5012};
+	static const int order[] = {6, 1, 4, 3, 5, 2}; //delayed out of release order
+	testKernelStart();
+	for(int i = 0; i < 6; i++)
+	{
+		testCreateTask(order[i], releaseOnce, order[i]);
+	}
+	testTicks(20);
+	CHECK(testLogEquals(expected, 6));
+}
+
+//Timeout of every task blocked across the wrap of SystemTick
+static const uint32_t WrapTimeout[NUM_TASKS] = {0, 20, 4, 10};
+
+//Waits for a notification that never comes, then records itself and the tick of its timeout
+static void timeoutAcrossWrap(void)
+{
+	ulTaskNotifyTake(true, WrapTimeout[CurrentTask->task]);
+	testRecord(CurrentTask->task);
+	testRecord((int)SystemTick);
+	testPark();
+}
+
+static void testDeltaQueueAcrossTickWrap(void)
+{
+	static const int expected[] = {2, -4, 3, 2, 1, 12};
+	testKernelStart();
+	SystemTick = 0xFFFFFFF8u; //8 ticks before SystemTick wraps to 0
+	testCreateTask(1, timeoutAcrossWrap, 1); //released after the wrap, queued first
+	testCreateTask(2, timeoutAcrossWrap, 2); //released before the wrap, new head of the queue
+	testCreateTask(3, timeoutAcrossWrap, 3);
+	testTicks(3);
+	CHECK(TestLogLength == 0);
+	testTicks(17);
+	CHECK(testLogEquals(expected, 6));
+}
+
+//Delays until tick 4 past the wrap of SystemTick, then records a single job
+static void releaseAfterWrap(void)
+{
+	int release = 4;
+	vTaskDelayUntil(&release, 100);
+	testRecord(JOB(CurrentTask->task));
+	testPark();
+}
+
+static void testDelayUntilAcrossTickWrap(void)
+{
+	static const int expected[] = {1004};
+	testKernelStart();
+	SystemTick = 0xFFFFFFF8u; //the release is still ahead, though below SystemTick unsigned
+	testCreateTask(1, releaseAfterWrap, 1);
+	testTicks(11);
+	CHECK(TestLogLength == 0);
+	testTicks(1);
+	CHECK(testLogEquals(expected, 1));
+}
+
+//Waits for the signal from the interrupt, then for the next one
+static void signalWaiter(void)
+{
+	xSemaphoreTake(&Semaphores[0]);
+	testRecord(CurrentTask->task);
+	xSemaphoreTake(&Semaphores[0]);
+	testRecord(CurrentTask->task);
+	testPark();
+}
+
+static void signalInterrupt(void)
+{
+	xSemaphoreGiveFromISR(&Semaphores[0]);
+}
+
+static void testSignalSemaphoreDoesNotInherit(void)
+{
+	static const int expected[] = {2, 1};
+	testKernelStart();
+	initSemaphoreSignal(Semaphores, 1);
+	portInitInterrupt(signalInterrupt);
+	testCreateTask(2, signalWaiter, 5);
+	portCauseInterrupt(); //handed to task 2, which waits for the next signal
+	testCreateTask(1, signalWaiter, 1);
+	CHECK(TCB[2].priority == 5); //the last task woken is no owner, waiters do not boost it
+	portCauseInterrupt();
+	CHECK(testLogEquals(expected, 2));
+}
+
+//------------------------------------------------------------------------------------------------//
+// -- 									SOFTWARE TIMERS										   -- //
+//------------------------------------------------------------------------------------------------//
+#define TEST_TIMERS 300			//timers started at once, several times TIMER_WHEEL_SLOTS
+#define TEST_TIMER_TICKS 1000	//longest timer period, far beyond one wheel rotation
+
+static xTimer Timers[TEST_TIMERS];
+static uint32_t TimerFired[TEST_TIMERS]; //expiries seen by the callback of each timer
+
+//Checks the timer expired exactly on its expiry tick, context is its index in Timers
+static void timerCallback(xTimer* timer)
+{
+	int i = (int)(intptr_t)timer->context;
+	CHECK(SystemTick == (TimerFired[i] + 1) * timer->period);
+	TimerFired[i]++;
+}
+
+static void testTimersHundreds(void)
+{
+	testKernelStart();
+	initTimerService(1, TestStacks[1], TEST_STACK_WORDS, 0);
+	for(int i = 0; i < TEST_TIMERS; i++)
+	{
+		//periods from 1 to TEST_TIMER_TICKS, started out of expiry order, a tenth auto-reload
+		uint32_t period = (uint32_t)(i * 337) % TEST_TIMER_TICKS + 1;
+		initTimer(&Timers[i], period, (i % 10) == 0, timerCallback, (void*)(intptr_t)i);
+		xTimerStart(&Timers[i]);
+	}
+	for(int i = 1; i < TEST_TIMERS; i += 50)
+	{
+		xTimerStop(&Timers[i]);
+	}
+	testTicks(2 * TEST_TIMER_TICKS);
+	for(int i = 0; i < TEST_TIMERS; i++)
+	{
+		uint32_t expected = 1;
+		if(i % 50 == 1)
+		{
+			expected = 0; //stopped
+		}
+		else if(i % 10 == 0)
+		{
+			expected = 2 * TEST_TIMER_TICKS / Timers[i].period;
+		}
+		CHECK(TimerFired[i] == expected);
+	}
+}
+
+static void testTimerFarExpiryWakesOnce(void)
+{
+	testKernelStart();
+	initTimerService(1, TestStacks[1], TEST_STACK_WORDS, 0);
+	initTimer(&Timers[0], TEST_TIMER_TICKS, false, timerCallback, (void*)0);
+	initTimer(&Timers[1], 10 * TEST_TIMER_TICKS, false, timerCallback, (void*)1);
+	xTimerStart(&Timers[0]);
+	xTimerStart(&Timers[1]);
+	uint32_t switches = TCB[1].switches;
+	testTicks(TEST_TIMER_TICKS);
+	CHECK(TimerFired[0] == 1);
+	CHECK(TCB[1].switches == switches + 1); //woken at the expiry only, not once per rotation
+}
+
+int main(void)
+{
+	int failures = 0;
+	failures += testRun("inherit: owner blocked on a mailbox", testInheritOwnerBlockedOnMailbox);
+	failures += testRun("inherit: unboosted periodic task accrues no boost time",
+						testBoostTicksUnboostedPeriodic);
+	failures += testRun("inherit: boost time of a periodic owner", testBoostTicksCountsBoost);
+	failures += testRun("inherit: signalling semaphores never boost a task",
+						testSignalSemaphoreDoesNotInherit);
+	failures += testRun("delay: same-tick releases run in priority order",
+						testSameTickReleasePriorityOrder);
+	failures += testRun("delay: same-tick releases of equal priority run in delay order",
+						testSameTickReleaseEqualPriority);
+	failures += testRun("delay: same-tick release while a task is running",
+						testSameTickReleaseWhileRunning);
+	failures += testRun("delay: mixed releases leave the delta queue in order",
+						testDeltaQueueMixedReleases);
+	failures += testRun("delay: releases stay in order across the SystemTick wrap",
+						testDeltaQueueAcrossTickWrap);
+	failures += testRun("delay: a release past the SystemTick wrap is still ahead",
+						testDelayUntilAcrossTickWrap);
+	failures += testRun("timers: hundreds of timers expire on their tick", testTimersHundreds);
+	failures += testRun("timers: a far expiry wakes the service once", testTimerFarExpiryWakesOnce);
+	return failures != 0;
+}
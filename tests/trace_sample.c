@@ -0,0 +1,107 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Trace Sample Recorder
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* trace_sample.c records the sample trace checked in as data/trace_sample.bin: a semaphore wait
+*  that times out, one that ends in a take, one woken by an ISR give whose task is preempted before
+*  it takes, a mailbox message and ISRs, recorded in snapshot mode on the POSIX port and dumped as
+*  the whole TraceBuffer. make run converts the sample with
+*  tools/trace2json and compares the result with data/trace_sample.json. Timestamps differ on
+*  every recording, so rerecord (make trace-sample) only when the trace format changes.
+*
+*  Usage: trace_sample trace.bin
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+#include <stdio.h>
+#include "port.h"
+#include "myRTOS.h"
+#include "myTrace.h"
+#include "test.h"
+
+static xSemaphore Semaphores[2];
+static xMailbox Box;
+
+//Holds the semaphore until notified, then sends a message
+static void ownerTask(void)
+{
+	int value = 42;
+	xSemaphoreTake(&Semaphores[0]);
+	ulTaskNotifyTake(true, WAIT_FOREVER);
+	xSemaphoreGive(&Semaphores[0]);
+	writeToBox(&Box, &value);
+	testPark();
+}
+
+//Times out on the semaphore once, then waits for it, reads the message and waits for the signal
+static void waiterTask(void)
+{
+	int value;
+	CHECK(xSemaphoreTakeTimeout(&Semaphores[0], 3) == RTOS_TIMEOUT);
+	xSemaphoreTake(&Semaphores[0]);
+	xSemaphoreGive(&Semaphores[0]);
+	readFromBox(&Box, &value);
+	xSemaphoreTake(&Semaphores[1]);
+	testPark();
+}
+
+//Released at tick 10, the moment the waiter has been woken but not yet taken the signal
+static void preempterTask(void)
+{
+	int release = 10;
+	vTaskDelayUntil(&release, 100);
+	testPark();
+}
+
+static void sampleInterrupt(void)
+{
+	TRACE_ISR_ENTER();
+	TRACE_ISR_EXIT();
+}
+
+//Signals the waiter with tick 10 pending, which is taken as soon as the waiter is switched in
+static void wakeInterrupt(void)
+{
+	TRACE_ISR_ENTER();
+	xSemaphoreGiveFromISR(&Semaphores[1]);
+	portStepTick(); //held off until the switch to the waiter unmasks interrupts
+	TRACE_ISR_EXIT();
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stderr, "usage: trace_sample trace.bin\n");
+		return 1;
+	}
+	testKernelStart();
+	portInitInterrupt(sampleInterrupt);
+	initSemaphoreBinary(Semaphores, 1);
+	initSemaphoreSignal(&Semaphores[1], 1);
+	initMailbox(&Box, 0);
+	vTraceStart(TRACE_MODE_SNAPSHOT);
+	testCreateTask(1, ownerTask, 4);
+	testCreateTask(2, waiterTask, 2);
+	testCreateTask(3, preempterTask, 1);
+	testTicks(5);
+	portCauseInterrupt();
+	xTaskNotifyGive(1);
+	testTicks(4);
+	portInitInterrupt(wakeInterrupt);
+	portCauseInterrupt();
+	CHECK(SystemTick == 10);
+	vTraceStop();
+	__disable_irq();
+
+	FILE* file = fopen(argv[1], "wb");
+	if(file == 0 || fwrite(&TraceBuffer, sizeof(TraceBuffer), 1, file) != 1 || fclose(file) != 0)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,435 @@
+//******************************************************************************************************
+//******************************************************************************************************
+//TITLE: My Real Time Operating System - Trace Converter
+//Version: 1.0
+//Author: Zachary Plato
+//Description:
+/* trace2json.c is a host tool decoding a myRTOS trace (see src/myTrace.h) into Chrome Trace Event
+ * JSON, viewable in chrome://tracing or ui.perfetto.dev. It accepts either a dump of the whole
+ * TraceBuffer (snapshot mode) or a file of raw xTraceRecords drained by uxTraceRead (stream mode).
+ * Output shows one track per task, blocked intervals per semaphore, mailbox message flow arrows
+ * and ISR slices. Records are decoded in a single pass with fixed lookup tables, so multi-megabyte
+ * captures convert in well under a second.
+ *
+ * Usage: trace2json [-c clock_hz] trace.bin > trace.json
+ */
+//******************************************************************************************************
+//******************************************************************************************************
+
+//Library Includes
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/myTrace.h"
+
+#define PID_TASKS 1			//process holding one track per task
+#define PID_SEMAPHORES 2	//process holding one track per semaphore
+#define PID_INTERRUPTS 3	//process holding one track per exception number
+#define MAX_TASKS 256		//xTraceRecord.task is 8 bits
+#define MAX_OBJECTS 65536	//xTraceRecord.object is 16 bits
+#define MAX_EXCEPTIONS 512	//IPSR is 9 bits
+
+//STRUCT: Block
+//DESCRIPTION: Semaphore wait in progress for one task
+typedef struct {
+	int active;				//task is blocked: 0 == false, 1 == true
+	uint16_t object;		//semaphore blocking the task
+	uint64_t start;			//cycle the task blocked
+} Block;
+
+//STRUCT: Message
+//DESCRIPTION: Mailbox value written but not yet read
+typedef struct {
+	uint64_t time;			//cycle the value was written
+	uint8_t task;			//writing task
+} Message;
+
+//STRUCT: Mailbox
+//DESCRIPTION: FIFO of messages in flight through one mailbox
+typedef struct {
+	Message *messages;		//ring of messages in flight
+	uint32_t size;			//capacity of messages (power of 2)
+	uint32_t head;			//oldest message
+	uint32_t count;			//messages in flight
+} Mailbox;
+
+static double ClockMHz;						//timestamp cycles per microsecond
+static uint64_t Now;						//unwrapped timestamp of the record being decoded
+static int Started;							//a record has been decoded: 0 == false, 1 == true
+static uint32_t LastStamp;					//raw timestamp of the previous record
+static int Running = -1;					//task currently running, -1 == unknown
+static uint64_t RunStart;					//cycle the running task was switched in
+static int TaskSeen[MAX_TASKS];				//task has appeared within the trace
+static uint8_t SemaphoreSeen[MAX_OBJECTS];	//semaphore has blocked a task within the trace
+static Block Blocks[MAX_TASKS];				//semaphore wait in progress per task
+static uint16_t Waiting[MAX_OBJECTS];		//tasks blocked on each object, not yet switched in again
+static uint16_t Given[MAX_OBJECTS];			//gives and posts to each object not yet matched by a wake
+static Mailbox Mailboxes[MAX_OBJECTS];		//messages in flight per mailbox
+static uint64_t IsrStart[MAX_EXCEPTIONS];	//cycle each active exception was entered
+static int IsrActive[MAX_EXCEPTIONS];		//exception is active: 0 == false, 1 == true
+static uint64_t FlowId;						//identifier of the next mailbox flow arrow
+static int First = 1;						//no event has been written: 0 == false, 1 == true
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: micros
+//*DESCRIPTION: Converts an unwrapped cycle count to microseconds
+//*INPUTS: cycles
+//*OUTPUTS: microseconds
+//------------------------------------------------------------------------------------------------//
+static double micros(uint64_t cycles)
+{
+	return (double)cycles / ClockMHz;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: separator
+//*DESCRIPTION: Writes the separator preceding every JSON event but the first
+//*INPUTS: N/A
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void separator(void)
+{
+	if(!First)
+	{
+		fputs(",\n", stdout);
+	}
+	First = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: emitSlice
+//*DESCRIPTION: Writes a complete ("X") event
+//*INPUTS: process, track, name, start and end cycle
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void emitSlice(int pid, int tid, const char* name, uint64_t start, uint64_t end)
+{
+	separator();
+	printf("{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f}",
+		   pid, tid, name, micros(start), micros(end - start));
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: emitInstant
+//*DESCRIPTION: Writes a thread scoped instant ("i") event
+//*INPUTS: process, track, name, object argument, cycle
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void emitInstant(int pid, int tid, const char* name, uint16_t object, uint64_t time)
+{
+	separator();
+	printf("{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"ts\":%.3f,"
+		   "\"args\":{\"object\":\"0x%04x\"}}", pid, tid, name, micros(time), object);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: emitFlow
+//*DESCRIPTION: Writes one end of a flow arrow ("s" start or "f" finish) between task tracks
+//*INPUTS: phase ('s' or 'f'), task track, flow identifier, cycle
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void emitFlow(char phase, int task, uint64_t id, uint64_t time)
+{
+	separator();
+	printf("{\"ph\":\"%c\",\"bp\":\"e\",\"cat\":\"mailbox\",\"name\":\"message\",\"pid\":%d,"
+		   "\"tid\":%d,\"id\":%llu,\"ts\":%.3f}", phase, PID_TASKS, task, (unsigned long long)id,
+		   micros(time));
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: emitName
+//*DESCRIPTION: Writes a metadata event naming a process or track
+//*INPUTS: "process_name" or "thread_name", process, track, name
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void emitName(const char* kind, int pid, int tid, const char* name)
+{
+	separator();
+	printf("{\"ph\":\"M\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+		   kind, pid, tid, name);
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: endBlock
+//*DESCRIPTION: Closes a task's semaphore wait as a slice on the semaphore's track, once the task
+//*is switched in again. A give or post to the semaphore since the task blocked woke it, else its
+//*timeout did. Each give wakes one waiter, so it is matched with the first one switched in.
+//*INPUTS: task, cycle the wait ended
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void endBlock(int task, uint64_t end)
+{
+	char name[48];
+	uint16_t object = Blocks[task].object;
+	const char* outcome = "timed out";
+	if(Given[object] != 0)
+	{
+		Given[object]--;
+		outcome = "blocked";
+	}
+	Waiting[object]--;
+	snprintf(name, sizeof(name), "Task %d %s", task, outcome);
+	emitSlice(PID_SEMAPHORES, object, name, Blocks[task].start, end);
+	Blocks[task].active = 0;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: signalObject
+//*DESCRIPTION: Notes a give or post to an object, which wakes one of the tasks blocked on it. Gives
+//*while no task is waiting leave the object available instead and wake nobody.
+//*INPUTS: object
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void signalObject(uint16_t object)
+{
+	if(Given[object] < Waiting[object])
+	{
+		Given[object]++;
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: mailboxPush
+//*DESCRIPTION: Queues a written message on a mailbox, growing its ring as needed
+//*INPUTS: mailbox object, writing task, cycle
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void mailboxPush(uint16_t object, uint8_t task, uint64_t time)
+{
+	Mailbox* box = &Mailboxes[object];
+	if(box->count == box->size)
+	{
+		uint32_t size = box->size ? box->size * 2 : 8;
+		Message* messages = malloc(size * sizeof(Message));
+		if(messages == 0)
+		{
+			fprintf(stderr, "trace2json: out of memory\n");
+			exit(1);
+		}
+		for(uint32_t i = 0; i < box->count; i++)
+		{
+			messages[i] = box->messages[(box->head + i) & (box->size - 1)];
+		}
+		free(box->messages);
+		box->messages = messages;
+		box->size = size;
+		box->head = 0;
+	}
+	Message* message = &box->messages[(box->head + box->count) & (box->size - 1)];
+	message->time = time;
+	message->task = task;
+	box->count++;
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: decode
+//*DESCRIPTION: Turns one trace record into Chrome Trace Events
+//*INPUTS: Address of the record
+//*OUTPUTS: N/A
+//------------------------------------------------------------------------------------------------//
+static void decode(const xTraceRecord* record)
+{
+	if(Started)
+	{
+		Now += (uint32_t)(record->timestamp - LastStamp); //unwrap the 32 bit cycle counter
+	}
+	Started = 1;
+	LastStamp = record->timestamp;
+
+	int task = record->task;
+	TaskSeen[task] = 1;
+
+	switch(record->event)
+	{
+	case TRACE_EVT_SWITCH:
+		if(Running >= 0)
+		{
+			emitSlice(PID_TASKS, Running, "running", RunStart, Now);
+		}
+		else if(Now != 0)
+		{
+			emitSlice(PID_TASKS, task, "running", 0, Now); //trace started within this slice
+		}
+		Running = record->object & (MAX_TASKS - 1);
+		TaskSeen[Running] = 1;
+		RunStart = Now;
+		if(Blocks[Running].active)
+		{
+			endBlock(Running, Now); //woken by a give or by its timeout, TAKE may come much later
+		}
+		break;
+	case TRACE_EVT_TICK:
+		emitInstant(PID_INTERRUPTS, 15, "tick", record->object, Now);
+		break;
+	case TRACE_EVT_SEM_TAKE:
+		emitInstant(PID_TASKS, task, "take", record->object, Now);
+		break;
+	case TRACE_EVT_SEM_GIVE:
+		signalObject(record->object);
+		emitInstant(PID_TASKS, task, "give", record->object, Now);
+		break;
+	case TRACE_EVT_SEM_BLOCK:
+		SemaphoreSeen[record->object] = 1;
+		Blocks[task].active = 1;
+		Blocks[task].object = record->object;
+		Waiting[record->object]++;
+		Blocks[task].start = Now;
+		break;
+	case TRACE_EVT_MBOX_WRITE:
+		signalObject(record->object);
+		mailboxPush(record->object, record->task, Now);
+		emitInstant(PID_TASKS, task, "mailbox write", record->object, Now);
+		break;
+	case TRACE_EVT_MBOX_READ:
+	{
+		emitInstant(PID_TASKS, task, "mailbox read", record->object, Now);
+		Mailbox* box = &Mailboxes[record->object];
+		if(box->count != 0) //writes before the trace started have no arrow
+		{
+			Message* message = &box->messages[box->head];
+			box->head = (box->head + 1) & (box->size - 1);
+			box->count--;
+			emitFlow('s', message->task, FlowId, message->time);
+			emitFlow('f', task, FlowId, Now);
+			FlowId++;
+		}
+		break;
+	}
+	case TRACE_EVT_ISR_ENTER:
+		IsrStart[record->object & (MAX_EXCEPTIONS - 1)] = Now;
+		IsrActive[record->object & (MAX_EXCEPTIONS - 1)] = 1;
+		break;
+	case TRACE_EVT_ISR_EXIT:
+	{
+		int exception = record->object & (MAX_EXCEPTIONS - 1);
+		if(IsrActive[exception])
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "IRQ %d", exception - 16);
+			emitSlice(PID_INTERRUPTS, exception, name, IsrStart[exception], Now);
+			IsrActive[exception] = 0;
+		}
+		break;
+	}
+	default:
+		break; //newer record types are skipped
+	}
+}
+
+//------------------------------------------------------------------------------------------------//
+//*FUNCTION: main
+//*DESCRIPTION: Reads a trace dump or stream and writes Chrome Trace Event JSON to stdout
+//*INPUTS: command line arguments
+//*OUTPUTS: 0 on success, 1 on error
+//------------------------------------------------------------------------------------------------//
+int main(int argc, char** argv)
+{
+	uint32_t clock_hz = 14000000; //stream mode default, the board's SystemCoreClock
+	const char* path = 0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+		{
+			clock_hz = (uint32_t)strtoul(argv[++i], 0, 0);
+		}
+		else
+		{
+			path = argv[i];
+		}
+	}
+	if(path == 0 || clock_hz == 0)
+	{
+		fprintf(stderr, "usage: trace2json [-c clock_hz] trace.bin > trace.json\n");
+		return 1;
+	}
+
+	FILE* file = fopen(path, "rb");
+	if(file == 0)
+	{
+		perror(path);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint8_t* data = malloc(length > 0 ? (size_t)length : 1);
+	if(data == 0 || fread(data, 1, (size_t)length, file) != (size_t)length)
+	{
+		fprintf(stderr, "trace2json: cannot read %s\n", path);
+		return 1;
+	}
+	fclose(file);
+
+	//A snapshot dump starts with the TraceBuffer header, a stream is records only
+	const xTraceRecord* records = (const xTraceRecord*)data;
+	uint32_t capacity = (uint32_t)((size_t)length / sizeof(xTraceRecord));
+	uint32_t first = 0;
+	uint32_t count = capacity;
+	size_t header = offsetof(xTraceBuffer, records);
+	if((size_t)length >= header && ((const xTraceBuffer*)data)->magic == TRACE_MAGIC)
+	{
+		const xTraceBuffer* buffer = (const xTraceBuffer*)data;
+		if(buffer->version != TRACE_VERSION || buffer->record_size != sizeof(xTraceRecord)
+		   || header + (size_t)buffer->capacity * sizeof(xTraceRecord) > (size_t)length)
+		{
+			fprintf(stderr, "trace2json: unsupported or truncated trace dump\n");
+			return 1;
+		}
+		records = buffer->records;
+		capacity = buffer->capacity;
+		count = (buffer->head - buffer->tail < capacity) ? buffer->head - buffer->tail : capacity;
+		first = buffer->head - count;
+		clock_hz = buffer->clock_hz ? buffer->clock_hz : clock_hz;
+		if(buffer->dropped != 0)
+		{
+			fprintf(stderr, "trace2json: %u records were dropped while recording\n", buffer->dropped);
+		}
+	}
+	ClockMHz = clock_hz / 1e6;
+
+	static char out[1 << 16];
+	setvbuf(stdout, out, _IOFBF, sizeof(out));
+	fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", stdout);
+	for(uint32_t i = 0; i < count; i++)
+	{
+		decode(&records[(first + i) % capacity]);
+	}
+	if(Running >= 0)
+	{
+		emitSlice(PID_TASKS, Running, "running", RunStart, Now); //still running at the end
+	}
+
+	emitName("process_name", PID_TASKS, 0, "Tasks");
+	emitName("process_name", PID_SEMAPHORES, 0, "Semaphores");
+	emitName("process_name", PID_INTERRUPTS, 0, "Interrupts");
+	for(int task = 0; task < MAX_TASKS; task++)
+	{
+		if(TaskSeen[task])
+		{
+			char name[32];
+			if(task == 0)
+			{
+				snprintf(name, sizeof(name), "Idle");
+			}
+			else
+			{
+				snprintf(name, sizeof(name), "Task %d", task);
+			}
+			emitName("thread_name", PID_TASKS, task, name);
+		}
+	}
+	for(int object = 0; object < MAX_OBJECTS; object++)
+	{
+		if(SemaphoreSeen[object])
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "Semaphore 0x%04x", object);
+			emitName("thread_name", PID_SEMAPHORES, object, name);
+		}
+	}
+	emitName("thread_name", PID_INTERRUPTS, 15, "SysTick");
+	fputs("\n]}\n", stdout);
+	free(data);
+	return 0;
+}